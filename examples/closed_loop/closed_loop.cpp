@@ -0,0 +1,154 @@
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <cmath>
+#include <chrono>
+#include <iostream>
+
+#include <rigid_body_fdm.hpp>
+#include "sl_controller.hpp"
+#include "sl_law.hpp"
+#include "aircraft.hpp"
+
+/*
+ Copyright (C) Andy Little 2021
+*/
+
+/**
+ * @file
+ * Fly sl_controller closed loop against rigid_body_fdm, the built in flight model, without FlightGear.
+ * The flight model is the controller's control sink, and the fdm frame it outputs is the controller's input,
+ * so the loop runs as fast as the cpu allows.
+ * At the end of each heading leg, checks the aircraft is level on the target heading sl_controller is flying to.
+ * usage:
+ *    closed_loop.exe [-t <flight time s>] [-r <fdm rate Hz>]
+ * defaults are 600 s at 10 Hz, as the --native-fdm rate in straightnlevel exec_flightgear.sh.
+ * Returns EXIT_FAILURE if a check fails or the aircraft reaches the ground
+**/
+
+namespace {
+
+   constexpr double default_flight_time_s = 600.0;
+   constexpr double default_rate_Hz = 10.0;
+   constexpr double max_rate_Hz = 1000.0;
+
+   constexpr double deg_per_rad = 180.0 / 3.14159265358979;
+   /// @brief limits at the end of each leg
+   constexpr double max_heading_error_deg = 2.0;
+   constexpr double max_roll_deg = 2.0;
+
+   /**
+    * @brief flight model parameters with the inertia and control torques of the aircraft sl_controller flies
+    **/
+   rigid_body_fdm_params get_fdm_params(aircraft const & a)
+   {
+      rigid_body_fdm_params params;
+      auto const inertia = a.get_inertia();
+      params.inertia[0] = inertia.x.numeric_value();
+      params.inertia[1] = inertia.y.numeric_value();
+      params.inertia[2] = inertia.z.numeric_value();
+      auto const torque = a.get_max_control_torque();
+      params.max_control_torque[0] = torque.x.numeric_value();
+      params.max_control_torque[1] = torque.y.numeric_value();
+      params.max_control_torque[2] = torque.z.numeric_value();
+      return params;
+   }
+
+   double constrain_angle_deg(double a)
+   {
+      return a - 360.0 * std::floor((a + 180.0) / 360.0);
+   }
+
+   const char* get_option(int argc, const char* argv[], const char* option)
+   {
+      for ( int i = 1; i < argc - 1; ++i){
+         if ( strcmp(argv[i],option) == 0){
+            return argv[i + 1];
+         }
+      }
+      return nullptr;
+   }
+}
+
+int main(const int argc, const char *argv[])
+{
+   const char* const time_option = get_option(argc,argv,"-t");
+   const char* const rate_option = get_option(argc,argv,"-r");
+   double const flight_time_s = (time_option != nullptr) ? atof(time_option) : default_flight_time_s;
+   double const rate_Hz = (rate_option != nullptr) ? atof(rate_option) : default_rate_Hz;
+   if ( (flight_time_s <= 0.0) || (rate_Hz < 1.0) || (rate_Hz > max_rate_Hz) ){
+      fprintf(stderr,"usage : %s [-t <flight time s>] [-r <fdm rate Hz, 1 to %.0f>]\n",argv[0],max_rate_Hz);
+      return EXIT_FAILURE;
+   }
+
+   try {
+      rigid_body_fdm fdm{get_fdm_params(aircraft{})};
+      sl_controller slfc{fdm};
+
+      quan::time::ms const time_step{1000.0 / rate_Hz};
+      uint64_t const num_frames = static_cast<uint64_t>(flight_time_s * rate_Hz + 0.5);
+      // the heading change interval of sl_controller
+      sl_law_params const schedule = sl_controller::get_law_params();
+      uint64_t const frames_per_leg = static_cast<uint64_t>(schedule.heading_change_time * rate_Hz + 0.5);
+
+      uint32_t num_legs = 0;
+      uint32_t num_failed_legs = 0;
+      bool completed = true;
+
+      auto const start = std::chrono::steady_clock::now();
+      for ( uint64_t frame = 0; frame <= num_frames; ++frame){
+         if ( (frame > 0) && (frame % frames_per_leg == 0) ){
+            // end of a leg, before the update that changes the target heading
+            double euler[3];
+            fdm.get_euler_angles(euler);
+            double const target_deg = constrain_angle_deg(slfc.get_target_heading() * deg_per_rad);
+            double const heading_error_deg = constrain_angle_deg(euler[2] * deg_per_rad - target_deg);
+            double const roll_deg = euler[0] * deg_per_rad;
+            bool const ok = (std::fabs(heading_error_deg) < max_heading_error_deg) &&
+               (std::fabs(roll_deg) < max_roll_deg);
+            fprintf(stdout,"leg %2u : t = %6.1f s, target heading % 7.2f deg, heading error % 6.2f deg, roll % 6.2f deg, "
+                  "altitude %7.1f m : %s\n",
+               num_legs + 1, fdm.get_time(), target_deg, heading_error_deg, roll_deg, fdm.get_altitude(),
+               ok ? "OK" : "FAIL"
+            );
+            ++num_legs;
+            if ( !ok){
+               ++num_failed_legs;
+            }
+         }
+         if ( frame == num_frames){
+            break;
+         }
+         if ( !slfc.update(fdm.get_fdm(),time_step)){
+            fprintf(stderr,"flight controller update failed\n");
+            completed = false;
+            break;
+         }
+         fdm.update(time_step);
+         if ( fdm.is_on_ground()){
+            fprintf(stdout,"aircraft reached the ground at t = %.1f s\n",fdm.get_time());
+            completed = false;
+            break;
+         }
+      }
+      auto const end = std::chrono::steady_clock::now();
+      double const run_time_s = std::chrono::duration<double>(end - start).count();
+
+      fprintf(stdout,"flew %.1f s in %.3f s",fdm.get_time(),run_time_s);
+      if ( run_time_s > 0.0){
+         fprintf(stdout,", %.0f x real time",fdm.get_time() / run_time_s);
+      }
+      fprintf(stdout,". %u of %u legs OK\n",num_legs - num_failed_legs,num_legs);
+
+      return (completed && (num_failed_legs == 0)) ? EXIT_SUCCESS : EXIT_FAILURE;
+   } catch (const char s[]) {
+      std::cerr << "Error: " << s << ": " << strerror(errno) << std::endl;
+   } catch (std::exception & e){
+      std::cerr << "Error: " << e.what() << std::endl;
+   } catch (...) {
+      std::cerr << "Error: unknown exception" << std::endl;
+   }
+   return EXIT_FAILURE;
+}
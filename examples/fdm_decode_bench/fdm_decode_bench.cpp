@@ -0,0 +1,217 @@
+
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+
+#include <autoconv_net_fdm.hpp>
+#include <fdm_state.hpp>
+
+/*
+ Copyright (C) Andy Little 2021
+*/
+
+/**
+ * @file
+ * Compare the cost of reading fdm values field by field via autoconv_FGNetFDM,
+ * which converts from network byte order on every read,
+ * with decoding the packet once to fdm_state using decode_fdm and reading that.
+ * No FlightGear required
+**/
+
+namespace {
+
+   using fdm_t = autoconv_FGNetFDM;
+
+   constexpr int num_frames = 1024;
+   constexpr int num_passes = 200;
+   constexpr int num_runs = 10;
+
+   fdm_t frames[num_frames];
+
+   volatile double sink = 0;
+
+   constexpr float m_per_ft = 0.3048f;
+
+   /**
+    * @brief fill the frames with plausible varying values
+    **/
+   void setup()
+   {
+      for ( int i = 0; i < num_frames; ++i){
+         float const t = i * 0.02f;
+         fdm_t & fdm = frames[i];
+         fdm.longitude = fdm_t::rad<double>{-0.0272 + t * 1e-6};
+         fdm.latitude = fdm_t::rad<double>{0.8850 + t * 1e-6};
+         fdm.altitude = fdm_t::meters<double>{800.0 + t};
+         fdm.agl = fdm_t::meters<>{200.f + t};
+         fdm.phi = fdm_t::rad<>{0.5f * std::sin(t)};
+         fdm.theta = fdm_t::rad<>{0.1f * std::cos(t)};
+         fdm.psi = fdm_t::rad<>{std::fmod(t,6.28f)};
+         fdm.alpha = fdm_t::rad<>{0.05f};
+         fdm.beta = fdm_t::rad<>{0.01f};
+         fdm.phidot = fdm_t::rad_per_s<>{fdm_t::rad<>{0.5f * std::cos(t)}};
+         fdm.thetadot = fdm_t::rad_per_s<>{fdm_t::rad<>{-0.1f * std::sin(t)}};
+         fdm.psidot = fdm_t::rad_per_s<>{fdm_t::rad<>{0.2f}};
+         fdm.vcas = fdm_t::knots<>{20.f + std::sin(t)};
+         fdm.climb_rate = fdm_t::ft_per_s<>{-1.f};
+         fdm.v_north = fdm_t::ft_per_s<>{30.f * std::cos(t)};
+         fdm.v_east = fdm_t::ft_per_s<>{30.f * std::sin(t)};
+         fdm.v_down = fdm_t::ft_per_s<>{1.f};
+         fdm.v_body_u = fdm_t::ft_per_s<>{33.f};
+         fdm.v_body_v = fdm_t::ft_per_s<>{0.1f};
+         fdm.v_body_w = fdm_t::ft_per_s<>{0.5f};
+         fdm.A_X_pilot = fdm_t::ft_per_s2<>{0.1f};
+         fdm.A_Y_pilot = fdm_t::ft_per_s2<>{0.2f};
+         fdm.A_Z_pilot = fdm_t::ft_per_s2<>{-32.2f};
+         fdm.cur_time = 1625000000U + static_cast<uint32_t>(i / 50);
+      }
+   }
+
+   /**
+    * @brief the reads sl_controller::pre_update makes per frame, field by field
+    **/
+   double controller_reads_per_field(fdm_t const & fdm)
+   {
+      return fdm.psi.get().numeric_value()
+         + fdm.psidot.get().numeric_value().numeric_value()
+         + fdm.phi.get().numeric_value()
+         + fdm.theta.get().numeric_value()
+         + fdm.phidot.get().numeric_value().numeric_value()
+         + fdm.thetadot.get().numeric_value().numeric_value()
+         + fdm.psidot.get().numeric_value().numeric_value();
+   }
+
+   /**
+    * @brief the same reads from a decoded fdm_state
+    **/
+   double controller_reads_decoded(fdm_state const & s)
+   {
+      return s.attitude.z.numeric_value()
+         + s.attitude_rate.z.numeric_value().numeric_value()
+         + s.attitude.x.numeric_value()
+         + s.attitude.y.numeric_value()
+         + s.attitude_rate.x.numeric_value().numeric_value()
+         + s.attitude_rate.y.numeric_value().numeric_value()
+         + s.attitude_rate.z.numeric_value().numeric_value();
+   }
+
+   /**
+    * @brief every value that decode_fdm converts, read field by field in SI units
+    **/
+   double all_reads_per_field(fdm_t const & fdm)
+   {
+      return fdm.longitude.get().numeric_value()
+         + fdm.latitude.get().numeric_value()
+         + fdm.altitude.get().numeric_value()
+         + fdm.agl.get().numeric_value()
+         + fdm.phi.get().numeric_value()
+         + fdm.theta.get().numeric_value()
+         + fdm.psi.get().numeric_value()
+         + fdm.alpha.get().numeric_value()
+         + fdm.beta.get().numeric_value()
+         + fdm.phidot.get().numeric_value().numeric_value()
+         + fdm.thetadot.get().numeric_value().numeric_value()
+         + fdm.psidot.get().numeric_value().numeric_value()
+         + quan::velocity_<float>::m_per_s{fdm.vcas.get()}.numeric_value()
+         + fdm.climb_rate.get().numeric_value() * m_per_ft
+         + fdm.v_north.get().numeric_value() * m_per_ft
+         + fdm.v_east.get().numeric_value() * m_per_ft
+         + fdm.v_down.get().numeric_value() * m_per_ft
+         + fdm.v_body_u.get().numeric_value() * m_per_ft
+         + fdm.v_body_v.get().numeric_value() * m_per_ft
+         + fdm.v_body_w.get().numeric_value() * m_per_ft
+         + fdm.A_X_pilot.get().numeric_value() * m_per_ft
+         + fdm.A_Y_pilot.get().numeric_value() * m_per_ft
+         + fdm.A_Z_pilot.get().numeric_value() * m_per_ft
+         + fdm.cur_time.get();
+   }
+
+   double all_reads_decoded(fdm_state const & s)
+   {
+      return s.longitude.numeric_value()
+         + s.latitude.numeric_value()
+         + s.altitude.numeric_value()
+         + s.agl.numeric_value()
+         + s.attitude.x.numeric_value()
+         + s.attitude.y.numeric_value()
+         + s.attitude.z.numeric_value()
+         + s.alpha.numeric_value()
+         + s.beta.numeric_value()
+         + s.attitude_rate.x.numeric_value().numeric_value()
+         + s.attitude_rate.y.numeric_value().numeric_value()
+         + s.attitude_rate.z.numeric_value().numeric_value()
+         + s.vcas.numeric_value()
+         + s.climb_rate.numeric_value()
+         + s.velocity_ned.x.numeric_value()
+         + s.velocity_ned.y.numeric_value()
+         + s.velocity_ned.z.numeric_value()
+         + s.velocity_body.x.numeric_value()
+         + s.velocity_body.y.numeric_value()
+         + s.velocity_body.z.numeric_value()
+         + s.accel_body.x.numeric_value()
+         + s.accel_body.y.numeric_value()
+         + s.accel_body.z.numeric_value()
+         + s.cur_time;
+   }
+
+   /**
+    * @brief run f over all frames num_passes times, num_runs times
+    * @return best ns per frame
+    **/
+   template <typename F>
+   double time_per_frame(F f)
+   {
+      double best = 1e30;
+      for ( int run = 0; run < num_runs; ++run){
+         double sum = 0;
+         auto const start = std::chrono::steady_clock::now();
+         for ( int pass = 0; pass < num_passes; ++pass){
+            for ( int i = 0; i < num_frames; ++i){
+               sum += f(frames[i]);
+            }
+         }
+         auto const end = std::chrono::steady_clock::now();
+         sink = sink + sum;
+         double const ns = std::chrono::duration<double,std::nano>(end - start).count()
+            / (static_cast<double>(num_passes) * num_frames);
+         if ( ns < best){
+            best = ns;
+         }
+      }
+      return best;
+   }
+}
+
+int main()
+{
+   setup();
+
+   fdm_state state;
+
+   double const decode_only = time_per_frame([&state](fdm_t const & fdm){
+      decode_fdm(fdm,state);
+      return static_cast<double>(state.cur_time);
+   });
+
+   double const ctrl_per_field = time_per_frame(controller_reads_per_field);
+
+   double const ctrl_decoded = time_per_frame([&state](fdm_t const & fdm){
+      decode_fdm(fdm,state);
+      return controller_reads_decoded(state);
+   });
+
+   double const all_per_field = time_per_frame(all_reads_per_field);
+
+   double const all_decoded = time_per_frame([&state](fdm_t const & fdm){
+      decode_fdm(fdm,state);
+      return all_reads_decoded(state);
+   });
+
+   fprintf(stdout,"fdm decode benchmark, best of %d runs, ns per frame\n",num_runs);
+   fprintf(stdout,"decode_fdm only                          : %8.2f ns\n",decode_only);
+   fprintf(stdout,"sl_controller reads, per field           : %8.2f ns\n",ctrl_per_field);
+   fprintf(stdout,"sl_controller reads, decode_fdm + state  : %8.2f ns\n",ctrl_decoded);
+   fprintf(stdout,"all decoded values, per field            : %8.2f ns\n",all_per_field);
+   fprintf(stdout,"all decoded values, decode_fdm + state   : %8.2f ns\n",all_decoded);
+   return 0;
+}
@@ -0,0 +1,235 @@
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <unistd.h>
+#include <arpa/inet.h>
+
+#include <fgfs_fdm_receiver.hpp>
+
+/*
+ Copyright (C) Andy Little 2021
+*/
+
+/**
+ * @file
+ * Multi reader stress test of fgfs_fdm_receiver, the seqlock publish path and the futex wakeup.
+ * A sender thread floods fdm sized packets to the receiver on loopback. Every 32 bit word of packet n is n,
+ * so a snapshot is torn if its words differ.
+ * Several reader threads block in wait_for_frame and one spins on get_fdm, and each checks every snapshot
+ * it takes is untorn and that frames never go backwards.
+ * usage:
+ *    fdm_receiver_stress.exe [-t <run time s>] [-n <waiting readers>] [-p <port>]
+ * Returns EXIT_FAILURE on a torn or out of order snapshot, or if no frames were received.
+ * No FlightGear required
+**/
+
+namespace {
+
+   QUAN_QUANTITY_LITERAL(time,ms)
+
+   constexpr double default_run_time_s = 2.0;
+   constexpr int default_num_waiting_readers = 3;
+   constexpr int max_num_waiting_readers = 32;
+   constexpr int32_t default_port = 5610;
+
+   constexpr size_t num_words = sizeof(autoconv_FGNetFDM) / sizeof(uint32_t);
+
+   struct reader_stats{
+      uint64_t num_loads = 0;
+      uint64_t num_new_frames = 0;
+      uint64_t num_torn = 0;
+      uint64_t num_out_of_order = 0;
+      uint64_t num_timeouts = 0;
+   };
+
+   /**
+    * @brief check a snapshot is one whole packet, and is not older than the last
+    **/
+   void check_snapshot(autoconv_FGNetFDM const & fdm, uint32_t frame, uint32_t & last_frame,
+      uint32_t & last_counter, reader_stats & stats)
+   {
+      uint32_t words[num_words];
+      ::memcpy(words,&fdm,sizeof(words));
+      ++stats.num_loads;
+      if ( frame == 0){
+         return;  // nothing published yet
+      }
+      for ( size_t i = 1; i < num_words; ++i){
+         if ( words[i] != words[0]){
+            ++stats.num_torn;
+            return;
+         }
+      }
+      if ( (frame < last_frame) || (words[0] < last_counter) ){
+         ++stats.num_out_of_order;
+      }
+      if ( frame != last_frame){
+         ++stats.num_new_frames;
+      }
+      last_frame = frame;
+      last_counter = words[0];
+   }
+
+   void run_waiting_reader(fgfs_fdm_receiver const & receiver, std::atomic<bool> const & running, reader_stats & stats)
+   {
+      uint32_t last_frame = 0;
+      uint32_t last_counter = 0;
+      while ( running.load(std::memory_order_relaxed)){
+         if ( !receiver.wait_for_frame(last_frame,100_ms)){
+            ++stats.num_timeouts;
+            continue;
+         }
+         autoconv_FGNetFDM fdm;
+         uint32_t const frame = receiver.get_fdm(fdm);
+         check_snapshot(fdm,frame,last_frame,last_counter,stats);
+      }
+   }
+
+   void run_spinning_reader(fgfs_fdm_receiver const & receiver, std::atomic<bool> const & running, reader_stats & stats)
+   {
+      uint32_t last_frame = 0;
+      uint32_t last_counter = 0;
+      while ( running.load(std::memory_order_relaxed)){
+         autoconv_FGNetFDM fdm;
+         uint32_t const frame = receiver.get_fdm(fdm);
+         check_snapshot(fdm,frame,last_frame,last_counter,stats);
+      }
+   }
+
+   /**
+    * @brief send packets with every word set to the packet number, as fast as possible
+    * @return number of packets sent
+    **/
+   uint64_t run_sender(int32_t port, std::atomic<bool> const & running)
+   {
+      int const fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+      if ( fd < 0){
+         throw("fdm_receiver_stress/socket");
+      }
+      sockaddr_in address;
+      ::memset(&address,0,sizeof(address));
+      address.sin_family = AF_INET;
+      address.sin_port = htons(port);
+      address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+      char packet[sizeof(autoconv_FGNetFDM)] = {0};
+      uint64_t num_sent = 0;
+      uint32_t counter = 0;
+      while ( running.load(std::memory_order_relaxed)){
+         ++counter;
+         for ( size_t i = 0; i < num_words; ++i){
+            ::memcpy(packet + i * sizeof(uint32_t),&counter,sizeof(uint32_t));
+         }
+         if ( ::sendto(fd,packet,sizeof(packet),0,reinterpret_cast<sockaddr const*>(&address),sizeof(address)) < 0){
+            if ( (errno != ENOBUFS) && (errno != EAGAIN) ){
+               ::close(fd);
+               throw("fdm_receiver_stress/sendto");
+            }
+         }else{
+            ++num_sent;
+         }
+      }
+      ::close(fd);
+      return num_sent;
+   }
+
+   void show(const char* name, int idx, reader_stats const & s)
+   {
+      fprintf(stdout,"%s %2d : %10llu loads, %9llu new frames, %llu torn, %llu out of order, %llu timeouts\n",
+         name, idx,
+         static_cast<unsigned long long>(s.num_loads),
+         static_cast<unsigned long long>(s.num_new_frames),
+         static_cast<unsigned long long>(s.num_torn),
+         static_cast<unsigned long long>(s.num_out_of_order),
+         static_cast<unsigned long long>(s.num_timeouts)
+      );
+   }
+
+   const char* get_option(int argc, const char* argv[], const char* option)
+   {
+      for ( int i = 1; i < argc - 1; ++i){
+         if ( strcmp(argv[i],option) == 0){
+            return argv[i + 1];
+         }
+      }
+      return nullptr;
+   }
+}
+
+int main(const int argc, const char *argv[])
+{
+   const char* const time_option = get_option(argc,argv,"-t");
+   const char* const readers_option = get_option(argc,argv,"-n");
+   const char* const port_option = get_option(argc,argv,"-p");
+   double const run_time_s = (time_option != nullptr) ? atof(time_option) : default_run_time_s;
+   int const num_waiting_readers = (readers_option != nullptr) ? atoi(readers_option) : default_num_waiting_readers;
+   int32_t const port = (port_option != nullptr) ? atoi(port_option) : default_port;
+   if ( (run_time_s <= 0.0) || (num_waiting_readers < 1) || (num_waiting_readers > max_num_waiting_readers) ){
+      fprintf(stderr,"usage : %s [-t <run time s>] [-n <waiting readers, 1 to %d>] [-p <port>]\n",
+         argv[0],max_num_waiting_readers);
+      return EXIT_FAILURE;
+   }
+
+   try {
+      fgfs_fdm_receiver receiver{"localhost",port};
+      receiver.start();
+
+      std::atomic<bool> readers_running{true};
+      std::vector<reader_stats> waiting_stats(num_waiting_readers);
+      reader_stats spinning_stats;
+      std::vector<std::thread> readers;
+      for ( int i = 0; i < num_waiting_readers; ++i){
+         readers.emplace_back([&,i]{ run_waiting_reader(receiver,readers_running,waiting_stats[i]);});
+      }
+      readers.emplace_back([&]{ run_spinning_reader(receiver,readers_running,spinning_stats);});
+
+      std::atomic<bool> sender_running{true};
+      uint64_t num_sent = 0;
+      std::thread sender{[&]{
+         try {
+            num_sent = run_sender(port,sender_running);
+         }catch(const char s[]){
+            fprintf(stderr,"Error: %s: %s\n",s,strerror(errno));
+         }
+      }};
+
+      ::usleep(static_cast<useconds_t>(run_time_s * 1e6));
+      sender_running = false;
+      sender.join();
+      readers_running = false;
+      for ( auto & t : readers){
+         t.join();
+      }
+      receiver.stop();
+
+      fprintf(stdout,"sent %llu packets, published %u frames, %llu skipped as stale\n",
+         static_cast<unsigned long long>(num_sent),
+         receiver.get_frame_count(),
+         static_cast<unsigned long long>(receiver.get_num_skipped())
+      );
+      bool ok = receiver.get_frame_count() > 0;
+      for ( int i = 0; i < num_waiting_readers; ++i){
+         show("waiting reader ",i,waiting_stats[i]);
+         ok = ok && (waiting_stats[i].num_torn == 0) && (waiting_stats[i].num_out_of_order == 0)
+            && (waiting_stats[i].num_new_frames > 0);
+      }
+      show("spinning reader",0,spinning_stats);
+      ok = ok && (spinning_stats.num_torn == 0) && (spinning_stats.num_out_of_order == 0);
+
+      fprintf(stdout,"%s\n", ok ? "OK" : "FAIL");
+      return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+   } catch (const char s[]) {
+      std::cerr << "Error: " << s << ": " << strerror(errno) << std::endl;
+   } catch (std::exception & e){
+      std::cerr << "Error: " << e.what() << std::endl;
+   } catch (...) {
+      std::cerr << "Error: unknown exception" << std::endl;
+   }
+   return EXIT_FAILURE;
+}
@@ -13,8 +13,10 @@
 
 #include "fgfs_telnet.hpp"
 #include "fgfs_fdm_in.hpp"
-#include <flight_controller.hpp>
+#include <telnet_control_sink.hpp>
+#include <control_pipeline.hpp>
 #include <joystick.hpp>
+#include <event_loop.hpp>
 /*
  Copyright (C) Andy Little 2021
  Derived from https://sourceforge.net/p/flightgear/flightgear/ci/next/tree/scripts/example/fgfsclient.cxx
@@ -35,7 +37,7 @@ namespace {
    QUAN_QUANTITY_LITERAL(time,s);
 
    // indirect system floating point type e.g for microcontrollers rpi etc
-   using float_type = quan::quantity_traits::default_value_type;
+   using float_type = control_float_type;
  
    /**
    *  @brief Display some FDM data to stdout to show what is what
@@ -93,8 +95,10 @@ int main(const int argc, const char *argv[])
             /**
              * Have joystick input, fdm and telnet so...
              * Create flight controller and plug in telnet and joystick. 
+             * The joystick is chained to the sink at compile time, so there are no virtual calls per frame
              **/
-            flight_controller fc(telnet_out,js);
+            telnet_control_sink sink{telnet_out};
+            static_flight_controller fc{js,sink};
 
             //for luck, check we are still getting data from FlightGear...
             while(!fdm_in.poll(1.0_s)){
@@ -105,26 +109,42 @@ int main(const int argc, const char *argv[])
 
             // OK start control loop.
             // Joystick should now be controlling aircraft in FlightGear
-            for (;;){
-               auto const now = std::chrono::steady_clock::now();
-               /**
-                 * @brief We should run at Flightgear fdm update rate, set on cmdline in --telnet... to 50 times a sec
-                 * Here is the elastic, if FlightGear is late
-               **/
-               if( fdm_in.poll(10.0_s)){
-                  fdm_in.update();
-                  output_fdm(fdm_in.get_fdm());
-                  if (!fc.update(fdm_in.get_fdm())){
-                     fprintf(stdout,"flight controller update failed - quitting\n");
-                     break;
-                  }
-               }else{
-                  fprintf(stdout,"FlightGear FDM update more than 10 s late");
+            event_loop loop;
+
+            /**
+              * @brief We run at Flightgear fdm update rate, set on cmdline in --native-fdm... to 50 times a sec
+              * The controller is updated as soon as each fdm packet arrives
+            **/
+            bool fdm_received = false;
+            loop.add_fd(fdm_in.get_fd(),[&]{
+               if ( !fdm_in.update_latest()){
+                  return;
                }
-               // wake up just before the next fdm packet is available from FlightGear (hopefully!)
-               //@todo wakeup on SIGIO ?, 
-               std::this_thread::sleep_until(now + 19ms);
-            }
+               fdm_received = true;
+               output_fdm(fdm_in.get_fdm());
+               if (!fc.update()){
+                  fprintf(stdout,"flight controller update failed - quitting\n");
+                  loop.stop();
+               }
+            });
+
+            // discard any telnet replies so the socket buffer doesnt fill
+            loop.add_fd(telnet_out.get_fd(),[&]{
+               if ( !telnet_out.drain_input()){
+                  fprintf(stdout,"FlightGear telnet closed - quitting\n");
+                  loop.stop();
+               }
+            });
+
+            // Here is the elastic, if FlightGear is late
+            loop.add_timer(10_s,[&](uint64_t){
+               if ( !fdm_received){
+                  fprintf(stdout,"FlightGear FDM update more than 10 s late\n");
+               }
+               fdm_received = false;
+            });
+
+            loop.run();
             return EXIT_SUCCESS;
          } catch (const char s[]) {
             std::cerr << "Error: " << s << ": " << strerror(errno) << std::endl;
@@ -0,0 +1,518 @@
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <cerrno>
+#include <csignal>
+#include <ctime>
+#include <unistd.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include <autoconv_net_fdm.hpp>
+#include <fgfs_property.hpp>
+#include <event_loop.hpp>
+#include <fixed_rate_scheduler.hpp>
+
+/*
+ Copyright (C) Andy Little 2021
+*/
+
+/**
+ * @file
+ * Stand in for FlightGear, for load testing fgfs_fdm_in, fgfs_telnet and the controllers on loopback.
+ * Streams synthetic FGNetFDM packets over UDP at a fixed rate and serves a subset of
+ * the FlightGear telnet props protocol : data, get, set, subscribe, unsubscribe and quit.
+ * The synthetic aircraft flies in circles, banked and pitched by the aileron and elevator properties.
+ * 
+ * mock_fgfs.exe [-r <fdm rate Hz>] [-f <fdm port>] [-t <telnet port>] [-h <fdm host>]
+ * defaults are 50 Hz to localhost:5600, telnet on 5501, as in exec_flightgear.sh
+ * Ctrl+C to stop and print the statistics
+**/
+
+namespace {
+
+   QUAN_QUANTITY_LITERAL(time,s)
+
+   using fdm_t = autoconv_FGNetFDM;
+
+   constexpr double min_rate_Hz = 1.0;
+   constexpr double max_rate_Hz = 10000.0;
+
+   constexpr size_t max_path_len = fgfs_property_detail::max_path_len;
+   constexpr size_t max_value_len = 32;
+   constexpr uint32_t max_props = 64;
+   /// @brief each client is a bit in property::subscribers
+   constexpr uint32_t max_clients = 8;
+   constexpr size_t max_line_len = 256;
+
+   struct property{
+      char path[max_path_len];
+      char value[max_value_len];
+      uint32_t subscribers;
+   };
+
+   property props[max_props];
+   uint32_t num_props = 0;
+
+   struct client{
+      int fd = -1;
+      bool data_mode = false;
+      char buffer[max_line_len];
+      size_t used = 0;
+   };
+
+   client clients[max_clients];
+
+   uint64_t num_gets = 0;
+   uint64_t num_sets = 0;
+   uint64_t num_pushes = 0;
+   uint64_t num_fdm_sent = 0;
+   uint64_t num_fdm_dropped = 0;
+
+   volatile sig_atomic_t stop_requested = 0;
+
+   void on_stop_signal(int)
+   {
+      stop_requested = 1;
+   }
+
+   /**
+    * @brief path without "[0]" indices, which FlightGear treats as the same node
+    **/
+   void normalise_path(const char* in, char* out)
+   {
+      size_t n = 0;
+      while ( (*in != '\0') && (n < max_path_len - 1)){
+         if ( (in[0] == '[') && (in[1] == '0') && (in[2] == ']') ){
+            in += 3;
+         }else{
+            out[n++] = *in++;
+         }
+      }
+      out[n] = '\0';
+   }
+
+   property* find_property(const char* path, bool create)
+   {
+      char normalised[max_path_len];
+      normalise_path(path,normalised);
+      for ( uint32_t i = 0; i < num_props; ++i){
+         if ( strcmp(props[i].path,normalised) == 0){
+            return &props[i];
+         }
+      }
+      if ( !create || (num_props == max_props)){
+         return nullptr;
+      }
+      property & p = props[num_props++];
+      strcpy(p.path,normalised);
+      strcpy(p.value,"0");
+      p.subscribers = 0;
+      return &p;
+   }
+
+   double get_double(fgfs_prop id)
+   {
+      property const * p = find_property(get_path(id),false);
+      return (p != nullptr) ? atof(p->value) : 0.0;
+   }
+
+   void send_to_client(client & c, const char* buf, size_t len)
+   {
+      // a client that cant keep up loses data rather than stalling the fdm stream
+      if ( ::send(c.fd, buf, len, MSG_DONTWAIT | MSG_NOSIGNAL) < 0){
+         if ( (errno != EAGAIN) && (errno != EWOULDBLOCK)){
+            fprintf(stderr,"telnet client send failed : %s\n",strerror(errno));
+         }
+      }
+   }
+
+   void send_line(client & c, const char* text)
+   {
+      char buf[max_line_len + 8];
+      int const len = snprintf(buf,sizeof(buf),"%s\r\n",text);
+      send_to_client(c,buf,static_cast<size_t>(len));
+   }
+
+   void send_prompt(client & c)
+   {
+      if ( !c.data_mode){
+         send_to_client(c,"/> ",3);
+      }
+   }
+
+   /**
+    * @brief push "path=value" to each subscriber, as FlightGear does when a subscribed property changes
+    **/
+   void push_to_subscribers(property const & p)
+   {
+      if ( p.subscribers == 0){
+         return;
+      }
+      char buf[max_path_len + max_value_len + 4];
+      int const len = snprintf(buf,sizeof(buf),"%s=%s\r\n",p.path,p.value);
+      for ( uint32_t i = 0; i < max_clients; ++i){
+         if ( (p.subscribers & (1U << i)) && (clients[i].fd >= 0) ){
+            send_to_client(clients[i],buf,static_cast<size_t>(len));
+            ++num_pushes;
+         }
+      }
+   }
+
+   /**
+    * @return false if the client should be disconnected
+    **/
+   bool do_command(client & c, uint32_t client_idx, char* line)
+   {
+      char* const cmd = strtok(line," \t");
+      if ( cmd == nullptr){
+         send_prompt(c);
+         return true;
+      }
+      char* const path = strtok(nullptr," \t");
+      char* const value = strtok(nullptr," \t");
+
+      if ( strcmp(cmd,"quit") == 0){
+         return false;
+      }
+      if ( strcmp(cmd,"data") == 0){
+         c.data_mode = true;
+      }else if ( strcmp(cmd,"prompt") == 0){
+         c.data_mode = false;
+      }else if ( strcmp(cmd,"get") == 0){
+         ++num_gets;
+         property const * p = (path != nullptr) ? find_property(path,false) : nullptr;
+         if ( p == nullptr){
+            char buf[max_line_len];
+            snprintf(buf,sizeof(buf),"-ERR Node \"%s\" not found.",(path != nullptr) ? path : "");
+            send_line(c,buf);
+         }else if ( c.data_mode){
+            send_line(c,p->value);
+         }else{
+            char buf[max_line_len];
+            snprintf(buf,sizeof(buf),"%s = '%s'",p->path,p->value);
+            send_line(c,buf);
+         }
+      }else if ( strcmp(cmd,"set") == 0){
+         ++num_sets;
+         property* const p = ((path != nullptr) && (value != nullptr)) ? find_property(path,true) : nullptr;
+         if ( p == nullptr){
+            send_line(c,"-ERR set failed");
+         }else if ( strcmp(p->value,value) != 0){
+            strncpy(p->value,value,max_value_len - 1);
+            p->value[max_value_len - 1] = '\0';
+            push_to_subscribers(*p);
+         }
+      }else if ( (strcmp(cmd,"subscribe") == 0) || (strcmp(cmd,"unsubscribe") == 0) ){
+         property* const p = (path != nullptr) ? find_property(path,true) : nullptr;
+         if ( p == nullptr){
+            send_line(c,"-ERR subscribe failed");
+         }else if ( cmd[0] == 's'){
+            p->subscribers |= (1U << client_idx);
+         }else{
+            p->subscribers &= ~(1U << client_idx);
+         }
+      }else{
+         send_line(c,"-ERR unknown command");
+      }
+      send_prompt(c);
+      return true;
+   }
+
+   void close_client(event_loop & loop, uint32_t idx)
+   {
+      client & c = clients[idx];
+      loop.remove_fd(c.fd);
+      ::close(c.fd);
+      c.fd = -1;
+      for ( uint32_t i = 0; i < num_props; ++i){
+         props[i].subscribers &= ~(1U << idx);
+      }
+      fprintf(stdout,"telnet client %u disconnected\n",idx);
+   }
+
+   /**
+    * @brief read and run all the complete command lines from a client
+    **/
+   void on_client_readable(event_loop & loop, uint32_t idx)
+   {
+      client & c = clients[idx];
+      ssize_t const n = ::recv(c.fd, c.buffer + c.used, sizeof(c.buffer) - c.used - 1, MSG_DONTWAIT);
+      if ( n <= 0){
+         if ( (n < 0) && ((errno == EAGAIN) || (errno == EINTR)) ){
+            return;
+         }
+         close_client(loop,idx);
+         return;
+      }
+      c.used += static_cast<size_t>(n);
+      c.buffer[c.used] = '\0';
+      char* start = c.buffer;
+      for(;;){
+         char* const eol = strchr(start,'\n');
+         if ( eol == nullptr){
+            break;
+         }
+         *eol = '\0';
+         if ( (eol > start) && (eol[-1] == '\r')){
+            eol[-1] = '\0';
+         }
+         if ( !do_command(c,idx,start)){
+            close_client(loop,idx);
+            return;
+         }
+         start = eol + 1;
+      }
+      c.used = strlen(start);
+      memmove(c.buffer,start,c.used);
+      if ( c.used == sizeof(c.buffer) - 1){
+         // no end of line in a full buffer
+         fprintf(stderr,"telnet client %u line too long, discarded\n",idx);
+         c.used = 0;
+      }
+   }
+
+   void on_accept(event_loop & loop, int listen_fd)
+   {
+      int const fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+      if ( fd < 0){
+         return;
+      }
+      for ( uint32_t i = 0; i < max_clients; ++i){
+         if ( clients[i].fd < 0){
+            int const one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            clients[i] = client{};
+            clients[i].fd = fd;
+            loop.add_fd(fd,[&loop,i]{ on_client_readable(loop,i);});
+            fprintf(stdout,"telnet client %u connected\n",i);
+            send_prompt(clients[i]);
+            return;
+         }
+      }
+      fprintf(stderr,"too many telnet clients\n");
+      ::close(fd);
+   }
+
+   int open_telnet_listener(int port)
+   {
+      int const fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+      if ( fd < 0){
+         throw("mock_fgfs/telnet socket");
+      }
+      int const one = 1;
+      ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+      sockaddr_in addr;
+      memset(&addr,0,sizeof(addr));
+      addr.sin_family = AF_INET;
+      addr.sin_port = htons(port);
+      addr.sin_addr.s_addr = htonl(INADDR_ANY);
+      if ( (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) || (::listen(fd, 4) < 0) ){
+         ::close(fd);
+         throw("mock_fgfs/telnet bind");
+      }
+      return fd;
+   }
+
+   int open_fdm_socket(const char* host, int port)
+   {
+      int const fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+      if ( fd < 0){
+         throw("mock_fgfs/fdm socket");
+      }
+      hostent* const hostinfo = ::gethostbyname(host);
+      if ( hostinfo == nullptr){
+         ::close(fd);
+         throw("mock_fgfs/unknown fdm host");
+      }
+      sockaddr_in addr;
+      memset(&addr,0,sizeof(addr));
+      addr.sin_family = AF_INET;
+      addr.sin_port = htons(port);
+      addr.sin_addr = *reinterpret_cast<in_addr*>(hostinfo->h_addr);
+      if ( ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0){
+         ::close(fd);
+         throw("mock_fgfs/fdm connect");
+      }
+      return fd;
+   }
+
+   /**
+    * @brief synthetic aircraft state, advanced each fdm frame
+    **/
+   struct mock_aircraft{
+      double latitude = 0.8850;   // rad
+      double longitude = -0.0272; // rad
+      double altitude = 800.0;    // m
+      double phi = 0.0;
+      double theta = 0.0;
+      double psi = 0.0;
+      double phidot = 0.0;
+      double thetadot = 0.0;
+      double psidot = 0.0;
+   };
+
+   constexpr double airspeed = 20.0;  // m/s
+   constexpr double gravity = 9.80665;
+   constexpr double earth_radius = 6378137.0;
+   constexpr double max_bank = 0.6;   // rad at full aileron
+   constexpr double max_pitch = 0.3;  // rad at full elevator
+   /// @brief first order time constant of attitude following the controls
+   constexpr double attitude_time_constant = 0.5; // s
+
+   void update_aircraft(mock_aircraft & a, double dt)
+   {
+      double const target_phi = get_double(fgfs_prop::Aileron) * max_bank;
+      double const target_theta = -get_double(fgfs_prop::Elevator) * max_pitch;
+      a.phidot = (target_phi - a.phi) / attitude_time_constant;
+      a.thetadot = (target_theta - a.theta) / attitude_time_constant;
+      a.psidot = gravity * tan(a.phi) / airspeed;
+      a.phi += a.phidot * dt;
+      a.theta += a.thetadot * dt;
+      a.psi = fmod(a.psi + a.psidot * dt + 2 * M_PI, 2 * M_PI);
+      double const v_north = airspeed * cos(a.theta) * cos(a.psi);
+      double const v_east = airspeed * cos(a.theta) * sin(a.psi);
+      double const v_down = -airspeed * sin(a.theta);
+      a.latitude += v_north * dt / earth_radius;
+      a.longitude += v_east * dt / (earth_radius * cos(a.latitude));
+      a.altitude -= v_down * dt;
+   }
+
+   constexpr double ft_per_m = 1.0 / 0.3048;
+
+   void fill_fdm(mock_aircraft const & a, fdm_t & fdm)
+   {
+      double const v_north = airspeed * cos(a.theta) * cos(a.psi);
+      double const v_east = airspeed * cos(a.theta) * sin(a.psi);
+      double const v_down = -airspeed * sin(a.theta);
+      fdm.version = FG_NET_FDM_VERSION;
+      fdm.longitude = fdm_t::rad<double>{a.longitude};
+      fdm.latitude = fdm_t::rad<double>{a.latitude};
+      fdm.altitude = fdm_t::meters<double>{a.altitude};
+      fdm.agl = fdm_t::meters<>{static_cast<float>(a.altitude - 600.0)};
+      fdm.phi = fdm_t::rad<>{static_cast<float>(a.phi)};
+      fdm.theta = fdm_t::rad<>{static_cast<float>(a.theta)};
+      fdm.psi = fdm_t::rad<>{static_cast<float>(a.psi)};
+      fdm.phidot = fdm_t::rad_per_s<>{fdm_t::rad<>{static_cast<float>(a.phidot)}};
+      fdm.thetadot = fdm_t::rad_per_s<>{fdm_t::rad<>{static_cast<float>(a.thetadot)}};
+      fdm.psidot = fdm_t::rad_per_s<>{fdm_t::rad<>{static_cast<float>(a.psidot)}};
+      fdm.vcas = fdm_t::knots<>{static_cast<float>(airspeed * 3600.0 / 1852.0)};
+      fdm.climb_rate = fdm_t::ft_per_s<>{static_cast<float>(-v_down * ft_per_m)};
+      fdm.v_north = fdm_t::ft_per_s<>{static_cast<float>(v_north * ft_per_m)};
+      fdm.v_east = fdm_t::ft_per_s<>{static_cast<float>(v_east * ft_per_m)};
+      fdm.v_down = fdm_t::ft_per_s<>{static_cast<float>(v_down * ft_per_m)};
+      fdm.v_body_u = fdm_t::ft_per_s<>{static_cast<float>(airspeed * ft_per_m)};
+      // in a coordinated turn the pilot feels gravity and the turn as one force along body z
+      fdm.A_Z_pilot = fdm_t::ft_per_s2<>{static_cast<float>(-gravity / cos(a.phi) * ft_per_m)};
+      fdm.cur_time = static_cast<uint32_t>(::time(nullptr));
+   }
+
+   const char* get_option(int argc, const char* argv[], const char* option)
+   {
+      for ( int i = 1; i < argc - 1; ++i){
+         if ( strcmp(argv[i],option) == 0){
+            return argv[i + 1];
+         }
+      }
+      return nullptr;
+   }
+}
+
+int main(const int argc, const char* argv[])
+{
+   const char* const rate_option = get_option(argc,argv,"-r");
+   const char* const fdm_port_option = get_option(argc,argv,"-f");
+   const char* const telnet_port_option = get_option(argc,argv,"-t");
+   const char* const host_option = get_option(argc,argv,"-h");
+
+   double const rate_Hz = (rate_option != nullptr) ? atof(rate_option) : 50.0;
+   if ( !(rate_Hz >= min_rate_Hz) || !(rate_Hz <= max_rate_Hz) ){
+      fprintf(stderr,"usage : %s [-r <fdm rate Hz %g to %g>] [-f <fdm port>] [-t <telnet port>] [-h <fdm host>]\n",
+         argv[0],min_rate_Hz,max_rate_Hz);
+      return EXIT_FAILURE;
+   }
+   int const fdm_port = (fdm_port_option != nullptr) ? atoi(fdm_port_option) : 5600;
+   int const telnet_port = (telnet_port_option != nullptr) ? atoi(telnet_port_option) : 5501;
+   const char* const host = (host_option != nullptr) ? host_option : "localhost";
+
+   int listen_fd = -1;
+   int fdm_fd = -1;
+   try {
+      // the properties the examples use, at FlightGear start up values
+      for ( uint32_t i = 0; i < static_cast<uint32_t>(fgfs_prop::NumProps); ++i){
+         find_property(get_path(static_cast<fgfs_prop>(i)),true);
+      }
+      snprintf(find_property(get_path(fgfs_prop::FrameRate),false)->value,max_value_len,"%d",60);
+
+      listen_fd = open_telnet_listener(telnet_port);
+      fdm_fd = open_fdm_socket(host,fdm_port);
+
+      struct sigaction sa;
+      memset(&sa,0,sizeof(sa));
+      sa.sa_handler = on_stop_signal;
+      ::sigemptyset(&sa.sa_mask);
+      ::sigaction(SIGINT,&sa,nullptr);
+      ::sigaction(SIGTERM,&sa,nullptr);
+
+      event_loop loop;
+      loop.add_fd(listen_fd,[&]{ on_accept(loop,listen_fd);});
+
+      mock_aircraft aircraft;
+      fdm_t fdm;
+      // fields the mock doesnt simulate are sent as zero
+      ::memset(static_cast<void*>(&fdm),0,sizeof(fdm));
+      double const period_s = 1.0 / rate_Hz;
+      fixed_rate_scheduler scheduler{"fdm out",quan::time::us{period_s * 1.e6}};
+      loop.add_timer(scheduler,[&](uint64_t periods){
+         update_aircraft(aircraft,period_s * periods);
+         fill_fdm(aircraft,fdm);
+         if ( ::send(fdm_fd, &fdm, sizeof(fdm), MSG_DONTWAIT) == sizeof(fdm)){
+            ++num_fdm_sent;
+         }else{
+            // ECONNREFUSED until something is listening
+            ++num_fdm_dropped;
+         }
+      });
+
+      loop.add_timer(1_s,[&](uint64_t){
+         if ( stop_requested){
+            loop.stop();
+         }
+      });
+
+      fprintf(stdout,"mock FlightGear : fdm at %g Hz to %s:%d, telnet on port %d\n",rate_Hz,host,fdm_port,telnet_port);
+      loop.run();
+
+      fprintf(stdout,"\nfdm packets sent = %llu, dropped = %llu\n",
+         static_cast<unsigned long long>(num_fdm_sent),
+         static_cast<unsigned long long>(num_fdm_dropped)
+      );
+      fprintf(stdout,"telnet gets = %llu, sets = %llu, subscription pushes = %llu\n",
+         static_cast<unsigned long long>(num_gets),
+         static_cast<unsigned long long>(num_sets),
+         static_cast<unsigned long long>(num_pushes)
+      );
+      scheduler.dump(stdout);
+      for ( auto & c : clients){
+         if ( c.fd >= 0){
+            ::close(c.fd);
+         }
+      }
+      ::close(fdm_fd);
+      ::close(listen_fd);
+      return EXIT_SUCCESS;
+   }catch (const char s[]) {
+      fprintf(stderr,"Error: %s : %s\n",s,strerror(errno));
+      if ( fdm_fd >= 0){
+         ::close(fdm_fd);
+      }
+      if ( listen_fd >= 0){
+         ::close(listen_fd);
+      }
+      return EXIT_FAILURE;
+   }
+}
@@ -10,6 +10,8 @@
 #include <autoconv_net_fdm.hpp>
 #include <arpa/inet.h>
 #include <byte_order.hpp>
+#include <fixed_rate_scheduler.hpp>
+#include <csignal>
 
 #include <quan/joystick.hpp>
 #include <quan/angle.hpp>
@@ -164,7 +166,6 @@ namespace {
    void update_world_frame(pose_t & result);
    void update_model_frame(pose_t & result);
    void update(autoconv_FGNetFDM & fdm, pose_t const & pose); 
-   void usleep(quan::time::us const & t);
    void run();
 
    int process_args(int argc, char ** argv);
@@ -305,8 +306,15 @@ namespace {
       setup(fdm);
       quan::joystick js{"/dev/input/js0"};
 
+      // kill -USR1 <pid> to see the loop timing
+      dump_latency_histograms_on_signal(SIGUSR1);
+
+      fixed_rate_scheduler scheduler{"fdm out loop",update_period};
       for(;;){
-         usleep(update_period);
+         scheduler.wait();
+         if ( take_latency_dump_request()){
+            scheduler.dump(stdout);
+         }
          update(pose,js);
          update(fdm,pose);
          sendto(fdmSendSocket,(void *)&fdm,sizeof(fdm),0,(struct sockaddr *)&fdmSendAddr,sizeof(fdmSendAddr));
@@ -421,12 +429,4 @@ namespace {
       fdm.left_flap = 0.f;
       fdm.right_flap = 0.f;
    };
-
-   /**
-    * wrap usleep with quan::time type
-   **/
-   void usleep(quan::time::us const & t)
-   {
-      ::usleep(static_cast<unsigned long>(t.numeric_value()));
-   }
 }
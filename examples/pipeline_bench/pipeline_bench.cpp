@@ -0,0 +1,170 @@
+
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+
+#include <control_pipeline.hpp>
+
+/*
+ Copyright (C) Andy Little 2021
+*/
+
+/**
+ * @file
+ * Compare the cost per frame of reading the controls from a joystick snapshot and sending them to a sink
+ * through abc_flight_controller::update, with control_dimension and abc_control_sink as manual_flight_controller,
+ * with the same through static_flight_controller::update and a pipeline_flight_controller.
+ * Each frame is a whole update, including the latency timing that control_sender adds to every controller.
+ * No FlightGear or joystick required
+**/
+
+namespace {
+
+   constexpr int num_frames = 1024;
+   constexpr int num_passes = 200;
+   constexpr int num_runs = 10;
+
+   joystick_state frames[num_frames];
+
+   /**
+    * @brief sums the values sent so the work can't be optimised away, and to check both paths agree
+    **/
+   struct sum_control_sink final : abc_control_sink{
+      bool set_control(FlightDimension d, float_type const & value) override
+      {
+         m_sum += value;
+         ++m_num_sets;
+         return true;
+      }
+      double m_sum = 0;
+      uint64_t m_num_sets = 0;
+   };
+
+   /**
+    * @brief fill the frames with plausible varying stick positions
+    **/
+   void setup()
+   {
+      for ( int i = 0; i < num_frames; ++i){
+         float const t = i * 0.02f;
+         joystick_state & js = frames[i];
+         js.axes[0] = static_cast<int16_t>(20000 * std::sin(t));
+         js.axes[1] = static_cast<int16_t>(10000 * std::cos(t));
+         js.axes[2] = static_cast<int16_t>(i % 4 == 0 ? 5000 : 5100);
+         js.axes[3] = static_cast<int16_t>(32767 * std::sin(3 * t));
+         js.axes[4] = -32767;
+         js.axes[5] = -32767;
+      }
+   }
+
+   /**
+    * @brief manual_flight_controller, but reading a joystick snapshot rather than a device
+    **/
+   struct snapshot_flight_controller final : abc_flight_controller{
+
+      snapshot_flight_controller(abc_control_sink & sink, joystick_state const & js)
+      : abc_flight_controller{sink},
+        m_roll{js}, m_pitch{js}, m_yaw{js}, m_throttle{js}, m_spoiler{js}, m_flap{js}
+      {}
+
+      float_type get_roll() const override{ return m_roll.get();}
+      float_type get_pitch() const override{ return m_pitch.get();}
+      float_type get_yaw() const override{ return m_yaw.get();}
+      float_type get_throttle() const override { return m_throttle.get();}
+      float_type get_spoiler() const override{ return m_spoiler.get();}
+      float_type get_flap() const override{ return m_flap.get();}
+
+   private:
+      joystick_dimension<FlightDimension::Roll> const m_roll;
+      joystick_dimension<FlightDimension::Pitch> const m_pitch;
+      joystick_dimension<FlightDimension::Yaw> const m_yaw;
+      joystick_dimension<FlightDimension::Throttle> const m_throttle;
+      joystick_dimension<FlightDimension::Spoiler> const m_spoiler;
+      joystick_dimension<FlightDimension::Flap> const m_flap;
+   };
+
+   /**
+    * @brief run f for each frame copied to the snapshot js, num_passes times, num_runs times
+    * @return best ns per frame
+    **/
+   template <typename F>
+   double time_per_frame(joystick_state & js, F f)
+   {
+      double best = 1e30;
+      for ( int run = 0; run < num_runs; ++run){
+         auto const start = std::chrono::steady_clock::now();
+         for ( int pass = 0; pass < num_passes; ++pass){
+            for ( int i = 0; i < num_frames; ++i){
+               js = frames[i];
+               f();
+            }
+         }
+         auto const end = std::chrono::steady_clock::now();
+         double const ns = std::chrono::duration<double,std::nano>(end - start).count()
+            / (static_cast<double>(num_passes) * num_frames);
+         if ( ns < best){
+            best = ns;
+         }
+      }
+      return best;
+   }
+
+   void show(const char* name, double ns, sum_control_sink const & sink)
+   {
+      fprintf(stdout,"%-40s %8.2f ns per frame, %llu sets, sum = %.6f\n",
+         name, ns, static_cast<unsigned long long>(sink.m_num_sets), sink.m_sum);
+   }
+}
+
+int main()
+{
+   setup();
+
+   joystick_state js{};
+   fdm_state const fdm{};
+   quan::time::ms const time_step{20};
+
+   // virtual, as manual_flight_controller. Called through a pointer so the compiler can't devirtualise
+   sum_control_sink virtual_sink;
+   snapshot_flight_controller snapshot_fc{virtual_sink,js};
+   abc_flight_controller * volatile virtual_fc_ptr = &snapshot_fc;
+   abc_flight_controller & virtual_fc = *virtual_fc_ptr;
+   double const virtual_ns = time_per_frame(js,[&]{ virtual_fc.update(fdm,time_step);});
+
+   // the same through a static pipeline
+   sum_control_sink static_sink;
+   static_flight_controller fc{limiter{joystick_state_source{js}}, static_sink};
+   double const static_ns = time_per_frame(js,[&]{ fc.update();});
+
+   // with trims mixed in
+   constant_source trim;
+   trim.set(FlightDimension::Pitch,0.05);
+   sum_control_sink mixed_sink;
+   static_flight_controller mixed_fc{limiter{mixer{joystick_state_source{js},trim}}, mixed_sink};
+   double const mixed_ns = time_per_frame(js,[&]{ mixed_fc.update();});
+
+   // the static pipeline behind the virtual interface
+   sum_control_sink pipeline_sink;
+   pipeline_flight_controller pipeline_fc{pipeline_sink,limiter{joystick_state_source{js}}};
+   abc_flight_controller * volatile pipeline_fc_ptr = &pipeline_fc;
+   abc_flight_controller & virtual_pipeline_fc = *pipeline_fc_ptr;
+   double const pipeline_ns = time_per_frame(js,[&]{ virtual_pipeline_fc.update(fdm,time_step);});
+
+   fprintf(stdout,"controls from joystick snapshot to sink, per frame:\n");
+   show("abc_flight_controller ( virtual)",virtual_ns,virtual_sink);
+   show("static_flight_controller",static_ns,static_sink);
+   show("static_flight_controller + trim mixer",mixed_ns,mixed_sink);
+   show("pipeline_flight_controller",pipeline_ns,pipeline_sink);
+
+   bool ok = true;
+   for ( auto const * sink : {&static_sink,&pipeline_sink}){
+      if ( (sink->m_num_sets != virtual_sink.m_num_sets) || (sink->m_sum != virtual_sink.m_sum) ){
+         ok = false;
+      }
+   }
+   if ( !ok){
+      fprintf(stdout,"error : static, pipeline and virtual paths disagree\n");
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,102 @@
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <iostream>
+
+#include <flight_recorder.hpp>
+#include <flight_replay.hpp>
+#include <trace_control_sink.hpp>
+#include "sl_controller.hpp"
+#include <latency_histogram.hpp>
+
+/*
+ Copyright (C) Andy Little 2021
+*/
+
+/**
+ * @file
+ * Replay a flight log recorded by straightnlevel -r <path> through sl_controller,
+ * as fast as possible and without FlightGear.
+ * Optionally writes the controls output each frame to a csv trace file,
+ * so that traces from before and after a controller change can be compared.
+ * usage:
+ *    replay.exe <flight_log> [trace.csv]
+**/
+
+namespace {
+
+   QUAN_QUANTITY_LITERAL(time,ms);
+
+   /**
+    * @brief used for the first frame. matches the --native-fdm rate in exec_flightgear.sh
+    **/
+   quan::time::ms constexpr default_time_step = 100_ms;
+}
+
+int main(const int argc, const char *argv[])
+{
+   if ( (argc < 2) || (argc > 3) ){
+      fprintf(stderr,"usage : %s <flight_log> [trace.csv]\n",argv[0]);
+      return EXIT_FAILURE;
+   }
+   FILE* trace_file = nullptr;
+   try {
+      flight_log_reader const log{argv[1]};
+
+      if ( argc == 3){
+         trace_file = fopen(argv[2],"w");
+         if ( trace_file == nullptr){
+            throw("replay/open trace file");
+         }
+      }
+
+      trace_control_sink sink{trace_file};
+      sl_controller slfc{sink};
+
+      int64_t first_time_ns = 0;
+      flight_replay_stats const stats = replay_flight_log(log,slfc,default_time_step,
+         [&](flight_log::fdm_record const & r){
+            if ( first_time_ns == 0){
+               first_time_ns = r.time_ns;
+            }
+            sink.set_frame_time((r.time_ns - first_time_ns) / 1.e9);
+         }
+      );
+
+      if ( trace_file != nullptr){
+         fclose(trace_file);
+         trace_file = nullptr;
+      }
+
+      double const flight_time_s = stats.flight_time_ns / 1.e9;
+      double const replay_time_s = stats.replay_time_ns / 1.e9;
+      fprintf(stdout,"replayed %llu frames ( %llu missing) of %.1f s flight in %.3f s",
+         static_cast<unsigned long long>(stats.num_frames),
+         static_cast<unsigned long long>(stats.num_missing),
+         flight_time_s,
+         replay_time_s
+      );
+      if ( replay_time_s > 0.0){
+         fprintf(stdout,", %.0f x real time",flight_time_s / replay_time_s);
+      }
+      fprintf(stdout,"\n");
+      dump_latency_histograms(stdout);
+
+      if ( !stats.completed){
+         fprintf(stderr,"flight controller update failed\n");
+         return EXIT_FAILURE;
+      }
+      return EXIT_SUCCESS;
+   } catch (const char s[]) {
+      std::cerr << "Error: " << s << ": " << strerror(errno) << std::endl;
+   } catch (std::exception & e){
+      std::cerr << "Error: " << e.what() << std::endl;
+   } catch (...) {
+      std::cerr << "Error: unknown exception" << std::endl;
+   }
+   if ( trace_file != nullptr){
+      fclose(trace_file);
+   }
+   return EXIT_FAILURE;
+}
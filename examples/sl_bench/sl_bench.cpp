@@ -0,0 +1,458 @@
+
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <sched.h>
+
+#include <quan/three_d/quat.hpp>
+#include <quan/three_d/rotation.hpp>
+#include <quan/three_d/make_vect.hpp>
+#include <quan/atan2.hpp>
+#include <quan/constrain.hpp>
+#include <quan/angular_velocity.hpp>
+
+#include "sl_controller.hpp"
+#include "sl_batch_controller.hpp"
+#include <control_sink.hpp>
+#include "aircraft.hpp"
+#include "get_sl_torque.hpp"
+#include "sl_error_angles.hpp"
+#include "sl_law.hpp"
+#include <fast_atan2.hpp>
+
+/*
+ Copyright (C) Andy Little 2021
+*/
+
+/**
+ * @file
+ * Measure the cost of the straight and level controller kernels, get_P_torque, get_I_torque,
+ * get_D_torque and the whole of sl_controller::pre_update, and of the atan2, z_rotation and
+ * quat_from_euler calls they are built from, in ns per call.
+ * sl_batch_controller::update is run over all the samples at once and shown in ns per aircraft,
+ * and its control values are checked against sl_controller.
+ * The fast math kernels, fast_atan2 and get_sl_error_angles, are timed and their worst case
+ * angle error against the exact path, get_exact_P_torque and get_exact_I_torque_step, is checked
+ * whether or not FG_SL_FAST_MATH is defined.
+ * sl_law, which sl_controller runs, is checked against the quan law get_exact_P_torque + get_D_torque.
+ * sl_law is timed for float, double and Q16.16 with its control values compared against double.
+ * Inputs are a fixed pseudo random set of attitudes and rates, mostly near level flight as in cruise.
+ * Each benchmark is run num_runs times after a warm up run. The best, median and worst run are shown,
+ * with the spread ( worst - best) / best, so a noisy result can be seen and rerun.
+ * Build with e.g make CXX=aarch64-linux-gnu-g++ to run on the flight computer.
+ * Returns 1 if a check fails.
+ * No FlightGear or joystick required
+**/
+
+QUAN_USING_ANGULAR_VELOCITY
+
+namespace {
+
+   QUAN_QUANTITY_LITERAL(angle,deg)
+   QUAN_QUANTITY_LITERAL(angle,rad)
+   QUAN_QUANTITY_LITERAL(time,ms)
+
+   constexpr int num_samples = 1024;
+   constexpr int num_passes = 200;
+   constexpr int num_runs = 15;
+
+   /**
+    * @brief largest difference allowed between the sl_batch_controller and sl_controller control values.
+    * The batch runs in float. sl_controller runs in control_float_type, or with FG_SL_FAST_MATH in float
+    * with the same polynomial trig as the batch
+    **/
+   constexpr float max_batch_control_diff = 1e-4f;
+
+   /**
+    * @brief largest difference allowed between get_sl_error_angles<false> and the exact path angles,
+    * for the body frame and the rotations done in float rather than double ( measured 1.4e-6).
+    * get_sl_error_angles<true> may add fast_atan2_max_error to this
+    **/
+   constexpr float max_float_angle_error = 4e-6f;
+
+   /**
+    * @brief largest torque difference allowed between sl_law<double> and the quan law, in N m.
+    * Both are double, and sl_law_params holds the aircraft constants in double, so only the order of operations differs
+    **/
+   constexpr double max_law_torque_diff = 1e-9;
+
+   using body_frame_t = quan::three_d::vect< quan::three_d::vect<double> >;
+
+   /// @brief World Frame axis unit vectors, as sl_controller
+   auto constexpr W = quan::three_d::make_vect(
+      quan::three_d::vect<double>{1,0,0},
+      quan::three_d::vect<double>{0,1,0},
+      quan::three_d::vect<double>{0,0,1}
+   );
+
+   fdm_state states[num_samples];
+   quan::three_d::vect<quan::angle::rad> attitudes[num_samples];
+   body_frame_t body_frames[num_samples];
+   quan::three_d::vect<rad_per_s> turn_rates[num_samples];
+
+   volatile double sink = 0;
+
+   /**
+    * @brief fill the inputs. Same seed every time so runs are comparable
+    **/
+   void setup()
+   {
+      std::mt19937 gen{20210601};
+      std::normal_distribution<float> roll_dist{0.f,15.f};
+      std::normal_distribution<float> pitch_dist{0.f,5.f};
+      std::uniform_real_distribution<float> yaw_dist{0.f,360.f};
+      std::normal_distribution<float> rate_dist{0.f,20.f};
+      constexpr float rad_per_deg = 3.14159265f / 180.f;
+
+      for ( int i = 0; i < num_samples; ++i){
+         float const roll = std::max(-80.f,std::min(80.f,roll_dist(gen))) * rad_per_deg;
+         float const pitch = std::max(-45.f,std::min(45.f,pitch_dist(gen))) * rad_per_deg;
+         float const yaw = yaw_dist(gen) * rad_per_deg;
+         float const rates[3] = {rate_dist(gen) * rad_per_deg, rate_dist(gen) * rad_per_deg, rate_dist(gen) * rad_per_deg};
+
+         fdm_state & s = states[i];
+         s.attitude = {fdm_state::rad<>{roll},fdm_state::rad<>{pitch},fdm_state::rad<>{yaw}};
+         s.attitude_rate = {
+            fdm_state::rad_per_s<>{fdm_state::rad<>{rates[0]}},
+            fdm_state::rad_per_s<>{fdm_state::rad<>{rates[1]}},
+            fdm_state::rad_per_s<>{fdm_state::rad<>{rates[2]}}
+         };
+         attitudes[i] = {quan::angle::rad{-roll},quan::angle::rad{pitch},0.0_rad};
+
+         // body frame as sl_controller derives it for a level target pose
+         auto const q = quan::three_d::unit_quat(quan::three_d::quat_from_euler<double>(attitudes[i]));
+         body_frames[i] = quan::three_d::make_vect(q * W.x, q * W.y, q * W.z);
+         turn_rates[i] = {-s.attitude_rate.x, s.attitude_rate.y, -s.attitude_rate.z};
+      }
+   }
+
+   struct result{
+      double best;
+      double median;
+      double worst;
+   };
+
+   /**
+    * @brief run f over all samples num_passes times, num_runs times after one warm up run
+    * @return ns per call statistics over the runs
+    **/
+   template <typename F>
+   result time_per_call(F f)
+   {
+      double ns_per_call[num_runs + 1];
+      for ( int run = 0; run < num_runs + 1; ++run){
+         double sum = 0;
+         auto const start = std::chrono::steady_clock::now();
+         for ( int pass = 0; pass < num_passes; ++pass){
+            for ( int i = 0; i < num_samples; ++i){
+               sum += f(i);
+            }
+         }
+         auto const end = std::chrono::steady_clock::now();
+         sink = sink + sum;
+         ns_per_call[run] = std::chrono::duration<double,std::nano>(end - start).count()
+            / (static_cast<double>(num_passes) * num_samples);
+      }
+      // first run is the warm up
+      std::sort(ns_per_call + 1, ns_per_call + num_runs + 1);
+      return {ns_per_call[1], ns_per_call[1 + num_runs / 2], ns_per_call[num_runs]};
+   }
+
+   void print_result(const char* name, result const & r)
+   {
+      fprintf(stdout,"%-34s : %9.2f %9.2f %9.2f %7.1f %%\n",
+         name, r.best, r.median, r.worst, 100.0 * (r.worst - r.best) / r.best);
+   }
+
+   /**
+    * @brief the error angles of the exact path, from get_exact_P_torque or get_exact_I_torque_step.
+    * Each torque component is ( r1 * I1 + r2 * I2) * accelK, so with accelK 1 and one unit
+    * inertia component at a time the torque components are the angles
+    **/
+   template <typename TorqueFunction>
+   sl_error_angles<> exact_error_angles(TorqueFunction torque, body_frame_t const & B)
+   {
+      quan::reciprocal_time2::per_s2 const accelK{1};
+      quan::moment_of_inertia::kg_m2 const one{1};
+      quan::moment_of_inertia::kg_m2 const zero{0};
+      auto const tx = torque(B,{one,zero,zero},accelK);  // {0, ryx, rzx}
+      auto const ty = torque(B,{zero,one,zero},accelK);  // {rxy, 0, rzy}
+      auto const tz = torque(B,{zero,zero,one},accelK);  // {rxz, ryz, 0}
+      auto const angle = [](quan::torque::N_m const & t){ return static_cast<float>(t.numeric_value());};
+      return {angle(ty.x), angle(tz.x), angle(tx.y), angle(tz.y), angle(tx.z), angle(ty.z)};
+   }
+
+   float max_abs_diff(sl_error_angles<> const & a, sl_error_angles<> const & b)
+   {
+      float const d[] = {a.rxy - b.rxy, a.rxz - b.rxz, a.ryx - b.ryx, a.ryz - b.ryz, a.rzx - b.rzx, a.rzy - b.rzy};
+      float r = 0.f;
+      for ( auto v : d){
+         r = std::max(r,std::abs(v));
+      }
+      return r;
+   }
+
+   /**
+    * @brief worst case error of the fast math kernels against the exact path,
+    * over the whole circle for fast_atan2 and over uniformly random attitudes for get_sl_error_angles,
+    * whose angles are compared with those of get_exact_P_torque and get_exact_I_torque_step
+    * @return false if an error is over its limit
+    **/
+   bool check_fast_math_error()
+   {
+      double max_atan2_error = 0;
+      constexpr int num_angles = 1000000;
+      for ( int i = 0; i < num_angles; ++i){
+         double const a = 2.0 * 3.14159265358979 * i / num_angles - 3.14159265358979;
+         float const y = static_cast<float>(std::sin(a));
+         float const x = static_cast<float>(std::cos(a));
+         double e = std::abs(fast_atan2(y,x) - std::atan2(static_cast<double>(y),static_cast<double>(x)));
+         if ( e > 3.14159265358979){
+            e = std::abs(e - 2.0 * 3.14159265358979);
+         }
+         max_atan2_error = std::max(max_atan2_error,e);
+      }
+
+      std::mt19937 gen{20210602};
+      std::uniform_real_distribution<double> angle_dist{-3.14159265358979,3.14159265358979};
+      float max_float_error = 0.f;
+      float max_fast_error = 0.f;
+      constexpr int num_attitudes = 100000;
+      for ( int i = 0; i < num_attitudes; ++i){
+         quan::three_d::vect<quan::angle::rad> const attitude = {
+            quan::angle::rad{angle_dist(gen)},
+            quan::angle::rad{angle_dist(gen) / 2},
+            quan::angle::rad{angle_dist(gen)}
+         };
+         auto const q = quan::three_d::unit_quat(quan::three_d::quat_from_euler<double>(attitude));
+         body_frame_t const B = quan::three_d::make_vect(q * W.x, q * W.y, q * W.z);
+         sl_error_angles<> const float_angles = get_sl_error_angles<false>(B);
+         sl_error_angles<> const fast_angles = get_sl_error_angles<true>(B);
+         for ( auto const & exact : {exact_error_angles(get_exact_P_torque,B),exact_error_angles(get_exact_I_torque_step,B)}){
+            max_float_error = std::max(max_float_error,max_abs_diff(exact,float_angles));
+            max_fast_error = std::max(max_fast_error,max_abs_diff(exact,fast_angles));
+         }
+      }
+      bool const atan2_ok = max_atan2_error <= fast_atan2_max_error;
+      bool const float_ok = max_float_error <= max_float_angle_error;
+      bool const fast_ok = max_fast_error <= fast_atan2_max_error + max_float_angle_error;
+      auto const status = [](bool ok){ return ok ? "OK" : "FAIL";};
+      fprintf(stdout,"fast math worst case error against exact path, rad\n");
+      fprintf(stdout,"%-34s : %9.3g, limit %9.3g : %s\n","fast_atan2",
+         max_atan2_error, static_cast<double>(fast_atan2_max_error), status(atan2_ok));
+      fprintf(stdout,"%-34s : %9.3g, limit %9.3g : %s\n","get_sl_error_angles<false>",
+         static_cast<double>(max_float_error), static_cast<double>(max_float_angle_error), status(float_ok));
+      fprintf(stdout,"%-34s : %9.3g, limit %9.3g : %s\n","get_sl_error_angles<true>",
+         static_cast<double>(max_fast_error), static_cast<double>(fast_atan2_max_error + max_float_angle_error), status(fast_ok));
+      return atan2_ok && float_ok && fast_ok;
+   }
+
+   /**
+    * @brief sl_law, which sl_controller runs, against the quan law it was derived from,
+    * get_exact_P_torque + get_D_torque, for the sample attitudes and rates with a level target pose
+    * @return false if a torque differs by more than max_law_torque_diff
+    **/
+   bool check_law_against_quan(aircraft const & the_aircraft)
+   {
+      sl_law_params params = sl_controller::get_law_params();
+      // level target pose, as body_frames
+      params.glide_pitch = 0;
+      sl_law_constants<double> const constants{params};
+      auto const inertia_v = the_aircraft.get_inertia();
+      double max_diff = 0;
+      for ( int i = 0; i < num_samples; ++i){
+         fdm_state const & st = states[i];
+         sl_torque<double> const law = get_sl_torque<false,double>(
+            st.attitude.x.numeric_value(), st.attitude.y.numeric_value(),
+            st.attitude_rate.x.numeric_value().numeric_value(),
+            st.attitude_rate.y.numeric_value().numeric_value(),
+            st.attitude_rate.z.numeric_value().numeric_value(),
+            0.0, constants
+         );
+         auto const torque = get_exact_P_torque(body_frames[i],inertia_v,the_aircraft.get_Kp())
+            + get_D_torque(turn_rates[i],inertia_v,the_aircraft.get_Kd());
+         max_diff = std::max(max_diff,std::abs(law.torque[0] - torque.x.numeric_value()));
+         max_diff = std::max(max_diff,std::abs(law.torque[1] - torque.y.numeric_value()));
+         max_diff = std::max(max_diff,std::abs(law.torque[2] - torque.z.numeric_value()));
+      }
+      bool const ok = max_diff <= max_law_torque_diff;
+      fprintf(stdout,"max sl_law torque difference from quan law, N m : %g, limit %g : %s\n",
+         max_diff, max_law_torque_diff, ok ? "OK" : "FAIL");
+      return ok;
+   }
+
+   /**
+    * @brief time sl_law<T> and compare its control values with sl_law<double>.
+    * Samples with a heading error within rounding of +-180 deg can turn the other way,
+    * so the mean difference is shown as well as the worst
+    **/
+   template <typename T>
+   void compare_numeric_type()
+   {
+      // roll, pitch, heading, roll_rate, pitch_rate, yaw_rate
+      static T inputs[num_samples][6];
+      static double reference_inputs[num_samples][6];
+      for ( int i = 0; i < num_samples; ++i){
+         fdm_state const & st = states[i];
+         float const v[6] = {
+            st.attitude.x.numeric_value(), st.attitude.y.numeric_value(), st.attitude.z.numeric_value(),
+            st.attitude_rate.x.numeric_value().numeric_value(),
+            st.attitude_rate.y.numeric_value().numeric_value(),
+            st.attitude_rate.z.numeric_value().numeric_value()
+         };
+         for ( int j = 0; j < 6; ++j){
+            inputs[i][j] = T(v[j]);
+            reference_inputs[i][j] = v[j];
+         }
+      }
+      auto const update = [](auto & law, auto const * in, auto dt){
+         law.update(in[0],in[1],in[2],in[3],in[4],in[5],dt);
+      };
+
+      sl_law_params const params = sl_controller::get_law_params();
+      sl_law<double> reference{params};
+      sl_law<T> law{params};
+      double max_diff = 0;
+      double sum_diff = 0;
+      for ( int i = 0; i < num_samples; ++i){
+         update(reference,reference_inputs[i],0.0);
+         update(law,inputs[i],T(0.0));
+         double const diff = std::max(
+            std::abs(static_cast<double>(reference.get_roll()) - static_cast<double>(law.get_roll())),
+            std::abs(static_cast<double>(reference.get_pitch()) - static_cast<double>(law.get_pitch()))
+         );
+         max_diff = std::max(max_diff,diff);
+         sum_diff += diff;
+      }
+      result const r = time_per_call([&](int i){
+         update(law,inputs[i],T(0.0));
+         return static_cast<double>(law.get_roll());
+      });
+      char name[40];
+      snprintf(name,sizeof(name),"sl_law<%s>",numeric_type_name<T>);
+      print_result(name,r);
+      fprintf(stdout,"%-34s   control difference from double : mean %9.3g, max %9.3g\n","",
+         sum_diff / num_samples, max_diff);
+   }
+
+   /// @brief run on one cpu, so the scheduler moving the thread doesnt add noise
+   void pin_to_cpu()
+   {
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      CPU_SET(0,&cpus);
+      if ( ::sched_setaffinity(0,sizeof(cpus),&cpus) != 0){
+         fprintf(stdout,"( couldnt pin to cpu 0, results may be noisier)\n");
+      }
+   }
+}
+
+int main()
+{
+   pin_to_cpu();
+   setup();
+
+   aircraft const the_aircraft;
+   auto const inertia_v = the_aircraft.get_inertia();
+   auto const Kp = the_aircraft.get_Kp();
+   auto const Kd = the_aircraft.get_Kd();
+
+   null_control_sink null_sink;
+   sl_controller slfc{null_sink};
+   // zero time step, so the controller doesnt keep changing heading and printing as the benchmark runs
+   quan::time::ms const time_step = 0_ms;
+
+   sl_batch_controller batch{num_samples,sl_controller::get_law_params()};
+   for ( int i = 0; i < num_samples; ++i){
+      batch.set_fdm(i,states[i]);
+   }
+
+   result const atan2_result = time_per_call([](int i){
+      return quan::atan2(body_frames[i].x.y,body_frames[i].x.x).numeric_value();
+   });
+
+   result const z_rotation_result = time_per_call([](int i){
+      auto const rot = quan::three_d::z_rotation(attitudes[i].x);
+      return rot(body_frames[i].y).x;
+   });
+
+   result const fast_atan2_result = time_per_call([](int i){
+      return fast_atan2(static_cast<float>(body_frames[i].x.y),static_cast<float>(body_frames[i].x.x));
+   });
+
+   result const quat_result = time_per_call([](int i){
+      return quan::three_d::quat_from_euler<double>(attitudes[i]).w;
+   });
+
+   result const P_result = time_per_call([&](int i){
+      return get_P_torque(body_frames[i],inertia_v,Kp).x.numeric_value();
+   });
+
+   result const exact_P_result = time_per_call([&](int i){
+      return get_exact_P_torque(body_frames[i],inertia_v,Kp).x.numeric_value();
+   });
+
+   result const float_angles_result = time_per_call([](int i){
+      return get_sl_error_angles<false>(body_frames[i]).rxy;
+   });
+
+   result const fast_angles_result = time_per_call([](int i){
+      return get_sl_error_angles<true>(body_frames[i]).rxy;
+   });
+
+   result const I_result = time_per_call([&](int i){
+      return get_I_torque(body_frames[i],inertia_v,20_ms).x.numeric_value();
+   });
+
+   result const D_result = time_per_call([&](int i){
+      return get_D_torque(turn_rates[i],inertia_v,Kd).x.numeric_value();
+   });
+
+   result const pre_update_result = time_per_call([&](int i){
+      slfc.pre_update(states[i],time_step);
+      return static_cast<double>(slfc.get_roll());
+   });
+
+   result const batch_result = time_per_call([&](int i){
+      if ( i == 0){
+         batch.update(time_step);
+      }
+      return static_cast<double>(batch.get_roll_control()[i]);
+   });
+
+   // both have now had their first heading change, so have the same target heading
+   float max_control_diff = 0.f;
+   for ( int i = 0; i < num_samples; ++i){
+      slfc.pre_update(states[i],time_step);
+      max_control_diff = std::max(max_control_diff,std::abs(static_cast<float>(slfc.get_roll()) - batch.get_roll_control()[i]));
+      max_control_diff = std::max(max_control_diff,std::abs(static_cast<float>(slfc.get_pitch()) - batch.get_pitch_control()[i]));
+   }
+
+   fprintf(stdout,"straight and level controller benchmark, %d samples x %d passes, %d runs%s\n",
+      num_samples,num_passes,num_runs, sl_fast_math ? ", FG_SL_FAST_MATH" : "");
+   fprintf(stdout,"%-34s : %9s %9s %9s %9s\n","ns per call","best","median","worst","spread");
+   print_result("quan::atan2",atan2_result);
+   print_result("fast_atan2",fast_atan2_result);
+   print_result("quan::three_d::z_rotation + apply",z_rotation_result);
+   print_result("quan::three_d::quat_from_euler",quat_result);
+   print_result("get_sl_error_angles<false>",float_angles_result);
+   print_result("get_sl_error_angles<true>",fast_angles_result);
+   print_result("get_P_torque",P_result);
+   print_result("get_exact_P_torque",exact_P_result);
+   print_result("get_I_torque",I_result);
+   print_result("get_D_torque",D_result);
+   print_result("sl_controller::pre_update",pre_update_result);
+   print_result("sl_batch_controller per aircraft",batch_result);
+   bool const batch_ok = max_control_diff <= max_batch_control_diff;
+   fprintf(stdout,"max sl_batch_controller control difference : %g, limit %g : %s\n",
+      static_cast<double>(max_control_diff), static_cast<double>(max_batch_control_diff), batch_ok ? "OK" : "FAIL");
+   bool const fast_math_ok = check_fast_math_error();
+   bool const law_ok = check_law_against_quan(the_aircraft);
+   fprintf(stdout,"numeric types\n");
+   compare_numeric_type<double>();
+   compare_numeric_type<float>();
+   compare_numeric_type<fixed_q16>();
+   return (batch_ok && fast_math_ok && law_ok) ? 0 : 1;
+}
@@ -107,6 +107,11 @@ namespace{
 
 }
 
+quan::three_d::vect<quan::torque::N_m> aircraft::get_max_control_torque() const
+{
+   return max_torque;
+}
+
 float aircraft::get_roll_control_value() const
 {
    return quan::constrain(m_control_torque.x / max_torque.x, -1.0,1.0);
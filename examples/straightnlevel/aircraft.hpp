@@ -30,6 +30,9 @@ struct aircraft{
    void set_control_torque(quan::three_d::vect<quan::torque::N_m> const & v)
    { m_control_torque = v;}
 
+   /// @brief torque at full control deflection, aileron, elevator, rudder
+   quan::three_d::vect<quan::torque::N_m> get_max_control_torque() const;
+
 
    float get_roll_control_value() const;
    float get_pitch_control_value() const;
@@ -14,6 +14,7 @@
 --glideslope=-3 \
 --native-fdm=socket,out,10,127.0.0.1,5600,udp \
 --telnet=socket,bi,30,localhost,5501,tcp \
+--native-ctrls=socket,in,30,,5700,udp \
 --httpd=8080
 
 
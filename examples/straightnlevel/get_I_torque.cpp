@@ -9,6 +9,7 @@
 #include <quan/three_d/make_vect.hpp>
 #include <quan/abs.hpp>
 #include "get_sl_torque.hpp"
+#include "sl_error_angles.hpp"
 
 namespace {
 
@@ -142,18 +143,34 @@ namespace {
 }
 
 quan::three_d::vect<quan::torque::N_m>
-get_I_torque(
+get_exact_I_torque_step(
    quan::three_d::vect< quan::three_d::vect<double> > const & body_frame_v, 
    quan::three_d::vect<quan::moment_of_inertia::kg_m2> const & inertia_v, 
-   quan::time::ms const & dt
+   quan::reciprocal_time2::per_s2 const & accelK
 )
 {
-   auto const accelK = dt/kIntegral ;
-   quan::three_d::vect<quan::torque::N_m> const torque_time_step = {
+   return {
       get_I_torque_xx(body_frame_v,inertia_v,accelK),
       get_I_torque_yy(body_frame_v,inertia_v,accelK),
       get_I_torque_zz(body_frame_v,inertia_v,accelK)
    };
+}
+
+quan::three_d::vect<quan::torque::N_m>
+get_I_torque(
+   quan::three_d::vect< quan::three_d::vect<double> > const & body_frame_v, 
+   quan::three_d::vect<quan::moment_of_inertia::kg_m2> const & inertia_v, 
+   quan::time::ms const & dt
+)
+{
+   auto const accelK = dt/kIntegral ;
+#if defined FG_SL_FAST_MATH
+   quan::three_d::vect<quan::torque::N_m> const torque_time_step =
+      get_torque_from_error_angles(get_sl_error_angles(body_frame_v),inertia_v,accelK);
+#else
+   quan::three_d::vect<quan::torque::N_m> const torque_time_step =
+      get_exact_I_torque_step(body_frame_v,inertia_v,accelK);
+#endif
 
    torque_integral.x = quan::constrain(torque_integral.x + torque_time_step.x , -torque_lim.x,torque_lim.x);
    torque_integral.y = quan::constrain(torque_integral.y + torque_time_step.y, -torque_lim.y,torque_lim.y);
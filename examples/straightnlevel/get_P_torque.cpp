@@ -7,6 +7,7 @@
 #include <quan/three_d/make_vect.hpp>
 #include <quan/abs.hpp>
 #include "get_sl_torque.hpp"
+#include "sl_error_angles.hpp"
 
 namespace {
 
@@ -121,7 +122,7 @@ namespace {
 } // namespace
 
 quan::three_d::vect<quan::torque::N_m> 
-get_P_torque(
+get_exact_P_torque(
    quan::three_d::vect< quan::three_d::vect<double> > const & body_frame_v, 
    quan::three_d::vect<quan::moment_of_inertia::kg_m2> const & inertia_v, 
    quan::reciprocal_time2::per_s2 const & accelK
@@ -134,4 +135,18 @@ get_P_torque(
    };
 }
 
+quan::three_d::vect<quan::torque::N_m> 
+get_P_torque(
+   quan::three_d::vect< quan::three_d::vect<double> > const & body_frame_v, 
+   quan::three_d::vect<quan::moment_of_inertia::kg_m2> const & inertia_v, 
+   quan::reciprocal_time2::per_s2 const & accelK
+)
+{
+#if defined FG_SL_FAST_MATH
+   return get_torque_from_error_angles(get_sl_error_angles(body_frame_v),inertia_v,accelK);
+#else
+   return get_exact_P_torque(body_frame_v,inertia_v,accelK);
+#endif
+}
+
 
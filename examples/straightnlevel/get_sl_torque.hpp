@@ -3,6 +3,18 @@
 
 //#define QUAN_STRAIGHT_N_LEVEL_FILTER
 
+/**
+ * define FG_SL_FAST_MATH ( or build with make FAST_MATH=1) for embedded builds where the libm calls
+ * dominate the frame time. sl_controller then runs its law ( sl_law.hpp) in float with the polynomial
+ * sin, cos and fast_atan2. get_P_torque and get_I_torque, which sl_bench times against the law,
+ * take their error angles from get_sl_error_angles ( sl_error_angles.hpp) using fast_atan2.
+**/
+//#define FG_SL_FAST_MATH
+
+#if defined FG_SL_FAST_MATH && defined QUAN_STRAIGHT_N_LEVEL_FILTER
+#error "FG_SL_FAST_MATH doesnt support QUAN_STRAIGHT_N_LEVEL_FILTER"
+#endif
+
 #include <quan/time.hpp>
 #include <quan/torque.hpp>
 #include <quan/moment_of_inertia.hpp>
@@ -23,6 +35,17 @@ get_P_torque(
    quan::reciprocal_time2::per_s2 const & accelK
 );
 
+/**
+ * @brief Proportional term from quan rotations and atan2 in double, whether or not FG_SL_FAST_MATH is defined.
+ * This is what get_P_torque returns without FG_SL_FAST_MATH, so the fast kernel can be checked against it
+**/
+quan::three_d::vect<quan::torque::N_m> 
+get_exact_P_torque(
+   quan::three_d::vect< quan::three_d::vect<double> > const & B, 
+   quan::three_d::vect<quan::moment_of_inertia::kg_m2> const & I, 
+   quan::reciprocal_time2::per_s2 const & accelK
+);
+
 /**
  * @brief Integral term
  * @param[in] B The body frame expressed as xyz unit vectors
@@ -36,6 +59,18 @@ get_I_torque(
    quan::time::ms const & dt
 );
 
+/**
+ * @brief the torque get_I_torque adds to its integral in one time step, before the limits,
+ * from quan rotations and atan2 in double whether or not FG_SL_FAST_MATH is defined
+ * @param[in] accelK dt / integral time constant cubed
+**/
+quan::three_d::vect<quan::torque::N_m>
+get_exact_I_torque_step(
+   quan::three_d::vect< quan::three_d::vect<double> > const & B, 
+   quan::three_d::vect<quan::moment_of_inertia::kg_m2> const & I, 
+   quan::reciprocal_time2::per_s2 const & accelK
+);
+
 /**
 * @brief differential term
 * @param[in] B The body frame expressed as xyz unit vectors
@@ -0,0 +1,124 @@
+
+#include "sl_batch_controller.hpp"
+
+/*
+ Copyright (C) Andy Little 2021
+*/
+
+namespace {
+
+   /// @brief arrays are padded to a multiple of this many floats ( 64 bytes)
+   constexpr uint32_t array_align = 16;
+   constexpr uint32_t num_arrays = 14;
+}
+
+sl_batch_controller::sl_batch_controller(uint32_t num_aircraft, sl_law_params const & params)
+: m_constants{params},
+  m_num_aircraft{num_aircraft},
+  m_stride{((num_aircraft + array_align - 1) / array_align) * array_align},
+  m_storage{new float[static_cast<size_t>(m_stride) * num_arrays + array_align]}
+{
+   // start each array on a 64 byte boundary
+   uintptr_t const base = reinterpret_cast<uintptr_t>(m_storage.get());
+   float* p = m_storage.get() + ((64 - (base % 64)) % 64) / sizeof(float);
+   float** const arrays[num_arrays] = {
+      &m_roll, &m_pitch, &m_heading, &m_roll_rate, &m_pitch_rate, &m_yaw_rate,
+      &m_target_heading, &m_time_since_heading_change, &m_target_roll,
+      &m_torque_x, &m_torque_y, &m_torque_z, &m_roll_control, &m_pitch_control
+   };
+   for ( auto a : arrays){
+      *a = p;
+      for ( uint32_t i = 0; i < m_stride; ++i){
+         p[i] = 0.f;
+      }
+      p += m_stride;
+   }
+   // as sl_controller, the heading change time starts expired so the first update changes heading
+   for ( uint32_t i = 0; i < m_stride; ++i){
+      m_target_heading[i] = m_constants.initial_target_heading;
+      m_time_since_heading_change[i] = m_constants.heading_change_time;
+   }
+}
+
+void sl_batch_controller::set_fdm(uint32_t i, fdm_state const & fdm)
+{
+   m_roll[i] = fdm.attitude.x.numeric_value();
+   m_pitch[i] = fdm.attitude.y.numeric_value();
+   m_heading[i] = fdm.attitude.z.numeric_value();
+   m_roll_rate[i] = fdm.attitude_rate.x.numeric_value().numeric_value();
+   m_pitch_rate[i] = fdm.attitude_rate.y.numeric_value().numeric_value();
+   m_yaw_rate[i] = fdm.attitude_rate.z.numeric_value().numeric_value();
+}
+
+void sl_batch_controller::update(quan::time::ms const & time_step)
+{
+   update_heading_schedule(time_step.numeric_value() / 1000.f);
+   update_target_roll();
+   update_torque();
+}
+
+/**
+ * The loops are in functions with restrict pointer parameters, since gcc ignores restrict on local pointers,
+ * and would otherwise version each loop with a runtime alias check per array ( more than it allows for update_torque)
+**/
+namespace {
+
+   void run_heading_schedule(uint32_t n, float dt, sl_law_constants<float> const & c,
+      float* __restrict target_heading, float* __restrict time_since_change)
+   {
+      for ( uint32_t i = 0; i < n; ++i){
+         update_sl_heading_schedule(target_heading[i],time_since_change[i],dt,c);
+      }
+   }
+
+   void run_target_roll(uint32_t n, sl_law_constants<float> const & c,
+      float const* __restrict heading, float const* __restrict yaw_rate, float const* __restrict target_heading,
+      float* __restrict target_roll)
+   {
+      for ( uint32_t i = 0; i < n; ++i){
+         target_roll[i] = get_sl_target_roll(heading[i],yaw_rate[i],target_heading[i],c);
+      }
+   }
+
+   void run_torque(uint32_t n, sl_law_constants<float> const & c,
+      float const* __restrict roll, float const* __restrict pitch,
+      float const* __restrict roll_rate, float const* __restrict pitch_rate, float const* __restrict yaw_rate,
+      float const* __restrict target_roll,
+      float* __restrict torque_x, float* __restrict torque_y, float* __restrict torque_z,
+      float* __restrict roll_control, float* __restrict pitch_control)
+   {
+      for ( uint32_t i = 0; i < n; ++i){
+         sl_torque<float> const t = get_sl_torque(roll[i],pitch[i],roll_rate[i],pitch_rate[i],yaw_rate[i],target_roll[i],c);
+         torque_x[i] = t.torque[0];
+         torque_y[i] = t.torque[1];
+         torque_z[i] = t.torque[2];
+         roll_control[i] = t.roll_control;
+         pitch_control[i] = t.pitch_control;
+      }
+   }
+}
+
+/**
+ * @brief Rarely taken branch, which gcc if-converts so the loop still vectorises
+**/
+void sl_batch_controller::update_heading_schedule(float dt)
+{
+   run_heading_schedule(m_num_aircraft,dt,m_constants,
+      m_target_heading,m_time_since_heading_change);
+}
+
+void sl_batch_controller::update_target_roll()
+{
+   run_target_roll(m_num_aircraft,m_constants,
+      m_heading,m_yaw_rate,m_target_heading,m_target_roll);
+}
+
+/**
+ * @brief With FG_SL_FAST_MATH the trig is polynomial, so the loop has no libm calls
+**/
+void sl_batch_controller::update_torque()
+{
+   run_torque(m_num_aircraft,m_constants,
+      m_roll,m_pitch,m_roll_rate,m_pitch_rate,m_yaw_rate,m_target_roll,
+      m_torque_x,m_torque_y,m_torque_z,m_roll_control,m_pitch_control);
+}
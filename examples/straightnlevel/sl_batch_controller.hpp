@@ -0,0 +1,90 @@
+#ifndef FG_EXT_SL_BATCH_CONTROLLER_HPP_INCLUDED
+#define FG_EXT_SL_BATCH_CONTROLLER_HPP_INCLUDED
+
+#include <cstdint>
+#include <memory>
+#include <quan/time.hpp>
+#include <fdm_state.hpp>
+#include "sl_law.hpp"
+
+/**
+ * @brief the straight and level law of sl_controller for many aircraft at once.
+ * State is held per aircraft in struct of arrays form, so each step of the law is a loop over
+ * contiguous floats.
+ * The heading schedule and target roll loops have no calls, and vectorise at -O3 -ffast-math where the target
+ * has a vector floor ( e.g x86-64 SSE4.1 or later, aarch64). The torque loop only vectorises with FG_SL_FAST_MATH,
+ * where the attitude trig is polynomial. Otherwise it calls libm sincosf and atan2f for each aircraft.
+ * sl_bench builds with these flags for this file only with make VECTORISE=1.
+ * There is no global state, so any number of batches can be used.
+ * All arrays are allocated in the constructor.
+**/
+struct sl_batch_controller{
+
+   /**
+    * @param params usually sl_controller::get_law_params()
+    **/
+   sl_batch_controller(uint32_t num_aircraft, sl_law_params const & params);
+
+   uint32_t get_num_aircraft() const { return m_num_aircraft;}
+
+   /**
+    * @brief set the inputs for aircraft i from its fdm
+    **/
+   void set_fdm(uint32_t i, fdm_state const & fdm);
+
+   /**
+    * @brief run the law for every aircraft
+    * @param time_step since the last update, for the heading schedule
+    **/
+   void update(quan::time::ms const & time_step);
+
+   /// @brief input arrays, num_aircraft long. euler angles in rad and euler rates in rad/s as fdm_state
+   float* get_roll() { return m_roll;}
+   float* get_pitch() { return m_pitch;}
+   float* get_heading() { return m_heading;}
+   float* get_roll_rate() { return m_roll_rate;}
+   float* get_pitch_rate() { return m_pitch_rate;}
+   float* get_yaw_rate() { return m_yaw_rate;}
+
+   /// @brief output arrays. P + D control torque in N m
+   float const* get_torque_x() const { return m_torque_x;}
+   float const* get_torque_y() const { return m_torque_y;}
+   float const* get_torque_z() const { return m_torque_z;}
+   /// @brief output arrays. control values in range -1 to 1 as sl_controller::get_roll, get_pitch
+   float const* get_roll_control() const { return m_roll_control;}
+   float const* get_pitch_control() const { return m_pitch_control;}
+
+   /// @brief target heading of each aircraft in rad
+   float const* get_target_heading() const { return m_target_heading;}
+
+private:
+   void update_heading_schedule(float dt);
+   void update_target_roll();
+   void update_torque();
+
+   /// @brief built once from the params, for all the update loops
+   sl_law_constants<float> const m_constants;
+   uint32_t const m_num_aircraft;
+   /// @brief num_aircraft rounded up so each array starts on a cache line
+   uint32_t const m_stride;
+   std::unique_ptr<float[]> m_storage;
+
+   float* m_roll;
+   float* m_pitch;
+   float* m_heading;
+   float* m_roll_rate;
+   float* m_pitch_rate;
+   float* m_yaw_rate;
+
+   float* m_target_heading;
+   float* m_time_since_heading_change;
+   float* m_target_roll;
+
+   float* m_torque_x;
+   float* m_torque_y;
+   float* m_torque_z;
+   float* m_roll_control;
+   float* m_pitch_control;
+};
+
+#endif // FG_EXT_SL_BATCH_CONTROLLER_HPP_INCLUDED
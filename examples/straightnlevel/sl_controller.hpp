@@ -0,0 +1,52 @@
+#ifndef EXT_FDM_SL_CONTROLLER_HPP_INCLUDED
+#define EXT_FDM_SL_CONTROLLER_HPP_INCLUDED
+
+#include "flight_controller.hpp"
+#include "sl_law.hpp"
+
+#define FG_EASYSTAR
+
+struct sl_controller final : abc_flight_controller{
+
+   /**
+    * @brief value type the law runs in. With FG_SL_FAST_MATH float, since the polynomial trig and fast_atan2
+    * kernels are float only, otherwise control_float_type
+    **/
+#if defined FG_SL_FAST_MATH
+   using law_value_type = float;
+#else
+   using law_value_type = control_float_type;
+#endif
+
+   sl_controller(abc_control_sink & sink)
+   : abc_flight_controller{sink}, m_law{get_law_params()}{}
+
+   float_type get_roll() const  override;
+   float_type get_pitch() const  override;
+   float_type get_yaw() const  override;
+#if defined FG_EASYSTAR
+   float_type get_throttle() const override{return 0; }
+#else
+   // Ask13
+   float_type get_throttle() const override{return 1; }
+#endif
+   float_type get_spoiler() const override{return 0; }
+   float_type get_flap() const  override{return 0; }
+
+   bool pre_update(fdm_state const & fdm, quan::time::ms const & time_step) override;
+
+   /**
+    * @brief the heading in rad, -pi to pi, that pre_update is turning the aircraft to
+    **/
+   float_type get_target_heading() const;
+
+   /**
+    * @brief the aircraft constants, gains and heading schedule of the law. Each sl_controller runs
+    * an sl_law<law_value_type> with them, and sl_batch_controller runs the same law for float
+    **/
+   static sl_law_params get_law_params();
+
+private:
+   sl_law<law_value_type> m_law;
+};
+#endif // EXT_FDM_SL_CONTROLLER_HPP_INCLUDED
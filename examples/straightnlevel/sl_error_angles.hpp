@@ -0,0 +1,129 @@
+#ifndef FG_EXT_SL_ERROR_ANGLES_HPP_INCLUDED
+#define FG_EXT_SL_ERROR_ANGLES_HPP_INCLUDED
+
+#include <cmath>
+#include <type_traits>
+#include <quan/angle.hpp>
+#include <quan/three_d/vect.hpp>
+#include <fast_atan2.hpp>
+#include <numeric_policy.hpp>
+#include "get_sl_torque.hpp"
+
+/**
+ * @brief the six constrained error angles that get_P_torque and get_I_torque derive from the body frame,
+ * computed straight from the body frame axes in value type T ( see numeric_policy.hpp).
+ * Where the torque functions build a z_rotation or x_rotation from an atan2 angle and apply it to each axis,
+ * the rotation is applied here using the normalised atan2 arguments as its cos and sin,
+ * which leaves 6 atan2 rather than 9 and no rotation objects.
+ * With Fast the float atan2 are fast_atan2, so each angle is within fast_atan2_max_error of the exact path
+ * plus float rounding ( sl_bench checks the worst case against get_exact_P_torque and get_exact_I_torque_step)
+**/
+template <typename T = float>
+struct sl_error_angles{
+   T rxy;  // x torque, y axis component
+   T rxz;  // x torque, z axis component
+   T ryx;
+   T ryz;
+   T rzx;
+   T rzy;
+};
+
+#if defined FG_SL_FAST_MATH
+constexpr bool sl_fast_math = true;
+#else
+constexpr bool sl_fast_math = false;
+#endif
+
+namespace sl_detail{
+
+   template <bool Fast, typename T>
+   inline T atan2(T y, T x)
+   {
+      if constexpr (Fast && std::is_same_v<T,float>){
+         return fast_atan2(y,x);
+      }else{
+         return numeric::atan2(y,x);
+      }
+   }
+
+   template <typename T>
+   inline T constrain_error_angle(T v)
+   {
+      T const lim(3.14159265358979 / 4);  // 45 deg
+      return numeric::constrain(v,-lim,lim);
+   }
+
+   /// @brief cos and sin of atan2(y,x), without the atan2
+   template <typename T>
+   inline void cos_sin_of_atan2(T y, T x, T & c, T & s)
+   {
+      T const zero(0.0);
+      T const one(1.0);
+      T const r2 = x * x + y * y;
+      T const inv_r = (r2 > zero) ? one / numeric::sqrt(r2) : zero;
+      c = (r2 > zero) ? x * inv_r : one;
+      s = y * inv_r;
+   }
+}
+
+/**
+ * @param B body frame as B[axis][component], i.e B[0] is B.x
+**/
+template <bool Fast = sl_fast_math, typename T>
+inline sl_error_angles<T> get_sl_error_angles(T const (&B)[3][3])
+{
+   using sl_detail::constrain_error_angle;
+   using sl_detail::cos_sin_of_atan2;
+
+   T const Bxx = B[0][0], Bxy = B[0][1], Bxz = B[0][2];
+   T const Byx = B[1][0], Byy = B[1][1], Byz = B[1][2];
+   T const Bzx = B[2][0], Bzy = B[2][1], Bzz = B[2][2];
+
+   sl_error_angles<T> r;
+   T c, s;
+   // rotated about z by -atan2(B.x.y, B.x.x)
+   cos_sin_of_atan2(-Bxy, Bxx, c, s);
+   r.rxy = constrain_error_angle(sl_detail::atan2<Fast,T>(Byz, Byx * s + Byy * c));
+   r.rxz = constrain_error_angle(-sl_detail::atan2<Fast,T>(Bzx * s + Bzy * c, Bzz));
+
+   // rotated about z by atan2(B.y.x, B.y.y)
+   cos_sin_of_atan2(Byx, Byy, c, s);
+   r.ryx = constrain_error_angle(-sl_detail::atan2<Fast,T>(Bxz, Bxx * c - Bxy * s));
+   r.ryz = constrain_error_angle(sl_detail::atan2<Fast,T>(Bzx * c - Bzy * s, Bzz));
+
+   // rotated about x by atan2(B.z.y, B.z.z)
+   cos_sin_of_atan2(Bzy, Bzz, c, s);
+   r.rzx = constrain_error_angle(sl_detail::atan2<Fast,T>(Bxy * c - Bxz * s, Bxx));
+   r.rzy = constrain_error_angle(-sl_detail::atan2<Fast,T>(Byx, Byy * c - Byz * s));
+   return r;
+}
+
+template <bool Fast = sl_fast_math>
+inline sl_error_angles<> get_sl_error_angles(quan::three_d::vect< quan::three_d::vect<double> > const & B)
+{
+   float const Bf[3][3] = {
+      {static_cast<float>(B.x.x), static_cast<float>(B.x.y), static_cast<float>(B.x.z)},
+      {static_cast<float>(B.y.x), static_cast<float>(B.y.y), static_cast<float>(B.y.z)},
+      {static_cast<float>(B.z.x), static_cast<float>(B.z.y), static_cast<float>(B.z.z)}
+   };
+   return get_sl_error_angles<Fast>(Bf);
+}
+
+/**
+ * @brief torque from the error angles, as get_P_torque and get_I_torque
+**/
+inline quan::three_d::vect<quan::torque::N_m>
+get_torque_from_error_angles(
+   sl_error_angles<> const & e,
+   quan::three_d::vect<quan::moment_of_inertia::kg_m2> const & inertia_v,
+   quan::reciprocal_time2::per_s2 const & accelK
+)
+{
+   return {
+      (quan::angle::rad{e.rxy} * inertia_v.y + quan::angle::rad{e.rxz} * inertia_v.z) * accelK,
+      (quan::angle::rad{e.ryx} * inertia_v.x + quan::angle::rad{e.ryz} * inertia_v.z) * accelK,
+      (quan::angle::rad{e.rzx} * inertia_v.x + quan::angle::rad{e.rzy} * inertia_v.y) * accelK
+   };
+}
+
+#endif // FG_EXT_SL_ERROR_ANGLES_HPP_INCLUDED
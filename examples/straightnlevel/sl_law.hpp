@@ -0,0 +1,247 @@
+#ifndef FG_EXT_SL_LAW_HPP_INCLUDED
+#define FG_EXT_SL_LAW_HPP_INCLUDED
+
+#include <cmath>
+#include <numeric_policy.hpp>
+#include "sl_error_angles.hpp"
+
+/**
+ * @file the straight and level law as templates over the value type T, float, double or fixed_q16
+ * ( see numeric_policy.hpp). It is the quan get_P_torque + get_D_torque law, which sl_bench checks it against.
+ * Angles are in rad, rates in rad/s, times in s and torques in N m.
+ * sl_law runs these for one aircraft, and each sl_controller runs an sl_law<sl_controller::law_value_type>.
+ * sl_batch_controller runs them for float over arrays
+**/
+
+/**
+ * @brief constants of the straight and level law, in double so each law rounds them once to its own value type.
+ * There are no defaults here. Get them from sl_controller::get_law_params(), which reads them from aircraft
+ * and the gains sl_controller flies with, so sl_law and sl_batch_controller cant drift from sl_controller
+**/
+struct sl_law_params{
+   /// @brief point mass inertia about x, y, z in kg m2, as aircraft::get_inertia
+   double inertia[3];
+   /// @brief proportional correcting angular acceleration in 1/s2, as aircraft::get_Kp
+   double accel_k;
+   /// @brief differential stopping time in s, as aircraft::get_Kd
+   double tstop;
+   /// @brief torque in N m at full control deflection, aileron, elevator, rudder, as aircraft::get_max_control_torque
+   double max_torque[3];
+   /// @brief yaw rate per rad of heading error in 1/s
+   double heading_error_to_yaw_rate;
+   /// @brief bank angle per rad/s of yaw rate error in s
+   double yaw_rate_error_to_roll;
+   /// @brief in rad/s
+   double max_yaw_rate;
+   /// @brief pitch to glide at in rad
+   double glide_pitch;
+   /// @brief target heading before the first heading change in rad
+   double initial_target_heading;
+   /// @brief heading change at each heading_change_time in rad
+   double heading_incr;
+   /// @brief in s
+   double heading_change_time;
+};
+
+/**
+ * @brief the constants of sl_law_params in T, with the divisions done once in double
+**/
+template <typename T>
+struct sl_law_constants{
+
+   explicit sl_law_constants(sl_law_params const & p)
+   : inertia{T(p.inertia[0]), T(p.inertia[1]), T(p.inertia[2])},
+     accel_k{T(p.accel_k)},
+     Kd{
+        T((p.inertia[1] + p.inertia[2]) / std::fmax(p.tstop,0.01)),
+        T((p.inertia[0] + p.inertia[2]) / std::fmax(p.tstop,0.01)),
+        T((p.inertia[0] + p.inertia[1]) / std::fmax(p.tstop,0.01))
+     },
+     inv_max_torque{T(1.0 / p.max_torque[0]), T(1.0 / p.max_torque[1])},
+     heading_error_to_yaw_rate{T(p.heading_error_to_yaw_rate)},
+     yaw_rate_error_to_roll{T(p.yaw_rate_error_to_roll)},
+     max_yaw_rate{T(p.max_yaw_rate)},
+     cos_half_glide_pitch{T(std::cos(p.glide_pitch * 0.5))},
+     sin_half_glide_pitch{T(std::sin(p.glide_pitch * 0.5))},
+     initial_target_heading{T(p.initial_target_heading)},
+     heading_incr{T(p.heading_incr)},
+     heading_change_time{T(p.heading_change_time)}
+   {}
+
+   T inertia[3];
+   T accel_k;
+   /// @brief D torque per rad/s of turn rate
+   T Kd[3];
+   /// @brief aileron and elevator
+   T inv_max_torque[2];
+   T heading_error_to_yaw_rate;
+   T yaw_rate_error_to_roll;
+   T max_yaw_rate;
+   T cos_half_glide_pitch;
+   T sin_half_glide_pitch;
+   T initial_target_heading;
+   T heading_incr;
+   T heading_change_time;
+};
+
+/**
+ * @brief angle in range -pi to pi. Branch free
+**/
+template <typename T>
+inline T sl_constrain_angle(T a)
+{
+   T const pi(3.14159265358979);
+   T const two_pi(6.28318530717959);
+   return a - two_pi * numeric::floor((a + pi) / two_pi);
+}
+
+/**
+ * @brief advance the heading schedule by time step dt
+**/
+template <typename T>
+inline void update_sl_heading_schedule(T & target_heading, T & time_since_heading_change, T dt,
+   sl_law_constants<T> const & c)
+{
+   time_since_heading_change += dt;
+   if ( time_since_heading_change >= c.heading_change_time){
+      target_heading = sl_constrain_angle(target_heading + c.heading_incr);
+      time_since_heading_change = T(0.0);
+   }
+}
+
+/**
+ * @brief heading error to yaw rate to bank angle
+ * @return target roll
+**/
+template <typename T>
+inline T get_sl_target_roll(T heading, T yaw_rate, T target_heading, sl_law_constants<T> const & c)
+{
+   T const half_pi(1.57079632679490);
+   T const heading_error = sl_constrain_angle(target_heading - sl_constrain_angle(heading));
+   T const target_yaw_rate = numeric::constrain(heading_error * c.heading_error_to_yaw_rate,
+      -c.max_yaw_rate, c.max_yaw_rate);
+   return -numeric::constrain((target_yaw_rate - yaw_rate) * c.yaw_rate_error_to_roll, -half_pi, half_pi);
+}
+
+namespace sl_detail{
+
+   /// @brief with Fast the float sin and cos are polynomial, so a loop over get_sl_torque has no libm calls
+   template <bool Fast, typename T>
+   inline T sin(T v)
+   {
+      if constexpr (Fast && std::is_same_v<T,float>){
+         return numeric::poly_sin(v);
+      }else{
+         return numeric::sin(v);
+      }
+   }
+
+   template <bool Fast, typename T>
+   inline T cos(T v)
+   {
+      if constexpr (Fast && std::is_same_v<T,float>){
+         return numeric::poly_sin(v + T(1.57079632679490));
+      }else{
+         return numeric::cos(v);
+      }
+   }
+}
+
+template <typename T>
+struct sl_torque{
+   T torque[3];
+   T roll_control;   // -1 to 1 as sl_controller::get_roll
+   T pitch_control;  // -1 to 1 as sl_controller::get_pitch
+};
+
+/**
+ * @brief pose error to body frame, then get_P_torque + get_D_torque and the control values
+**/
+template <bool Fast = sl_fast_math, typename T>
+inline sl_torque<T> get_sl_torque(T roll, T pitch, T roll_rate, T pitch_rate, T yaw_rate, T target_roll,
+   sl_law_constants<T> const & c)
+{
+   T const half(0.5);
+   T const one(1.0);
+   T const two(2.0);
+   // current pose { -roll, pitch, 0} and target pose {target_roll, glide_pitch, 0} as quaternions
+   T const ccr = sl_detail::cos<Fast>(-roll * half);
+   T const scr = sl_detail::sin<Fast>(-roll * half);
+   T const ccp = sl_detail::cos<Fast>(pitch * half);
+   T const scp = sl_detail::sin<Fast>(pitch * half);
+   T const c0 = ccr * ccp, c1 = scr * ccp, c2 = ccr * scp, c3 = -scr * scp;
+
+   T const ctr = sl_detail::cos<Fast>(target_roll * half);
+   T const str = sl_detail::sin<Fast>(target_roll * half);
+   // conjugate of target
+   T const ctp = c.cos_half_glide_pitch;
+   T const stp = c.sin_half_glide_pitch;
+   T const t0 = ctr * ctp, t1 = -str * ctp, t2 = -ctr * stp, t3 = str * stp;
+
+   // pose error = current * conjugate(target)
+   T w = c0 * t0 - c1 * t1 - c2 * t2 - c3 * t3;
+   T x = c0 * t1 + c1 * t0 + c2 * t3 - c3 * t2;
+   T y = c0 * t2 - c1 * t3 + c2 * t0 + c3 * t1;
+   T z = c0 * t3 + c1 * t2 - c2 * t1 + c3 * t0;
+   T const inv_n = one / numeric::sqrt(w * w + x * x + y * y + z * z);
+   w = w * inv_n; x = x * inv_n; y = y * inv_n; z = z * inv_n;
+
+   // body frame, the columns of the pose error rotation
+   T const B[3][3] = {
+      {one - two * (y * y + z * z), two * (x * y + w * z), two * (x * z - w * y)},
+      {two * (x * y - w * z), one - two * (x * x + z * z), two * (y * z + w * x)},
+      {two * (x * z + w * y), two * (y * z - w * x), one - two * (x * x + y * y)}
+   };
+   sl_error_angles<T> const e = get_sl_error_angles<Fast>(B);
+
+   // P terms, plus D terms from turn rate { -roll_rate, pitch_rate, -yaw_rate}
+   sl_torque<T> r;
+   r.torque[0] = (e.rxy * c.inertia[1] + e.rxz * c.inertia[2]) * c.accel_k - roll_rate * c.Kd[0];
+   r.torque[1] = (e.ryx * c.inertia[0] + e.ryz * c.inertia[2]) * c.accel_k + pitch_rate * c.Kd[1];
+   r.torque[2] = (e.rzx * c.inertia[0] + e.rzy * c.inertia[1]) * c.accel_k - yaw_rate * c.Kd[2];
+   r.roll_control = numeric::constrain(r.torque[0] * c.inv_max_torque[0], -one, one);
+   r.pitch_control = numeric::constrain(r.torque[1] * c.inv_max_torque[1], -one, one);
+   return r;
+}
+
+/**
+ * @brief the straight and level law for one aircraft in value type T, with its own heading schedule.
+ * There is no global state, and no quan or libm calls for fixed_q16
+**/
+template <typename T>
+struct sl_law{
+
+   /**
+    * @param params usually sl_controller::get_law_params()
+    **/
+   explicit sl_law(sl_law_params const & params)
+   : m_constants{params},
+     m_target_heading{m_constants.initial_target_heading},
+     m_time_since_heading_change{m_constants.heading_change_time},
+     m_output{}
+   {}
+
+   /**
+    * @brief euler angles in rad and euler rates in rad/s as fdm_state
+    * @param dt time step in s, for the heading schedule
+    **/
+   void update(T roll, T pitch, T heading, T roll_rate, T pitch_rate, T yaw_rate, T dt)
+   {
+      update_sl_heading_schedule(m_target_heading,m_time_since_heading_change,dt,m_constants);
+      T const target_roll = get_sl_target_roll(heading,yaw_rate,m_target_heading,m_constants);
+      m_output = get_sl_torque(roll,pitch,roll_rate,pitch_rate,yaw_rate,target_roll,m_constants);
+   }
+
+   sl_torque<T> const & get_output() const { return m_output;}
+   control_float_type get_roll() const { return static_cast<control_float_type>(m_output.roll_control);}
+   control_float_type get_pitch() const { return static_cast<control_float_type>(m_output.pitch_control);}
+   T get_target_heading() const { return m_target_heading;}
+
+private:
+   sl_law_constants<T> const m_constants;
+   T m_target_heading;
+   T m_time_since_heading_change;
+   sl_torque<T> m_output;
+};
+
+#endif // FG_EXT_SL_LAW_HPP_INCLUDED
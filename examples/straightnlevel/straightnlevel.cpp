@@ -1,6 +1,9 @@
 
 #include <cstring>
+#include <cstdlib>
+#include <csignal>
 #include <string>
+#include <memory>
 
 #include <iostream>
 #include <chrono>
@@ -16,10 +19,20 @@
 #include <fgfs_telnet.hpp>
 #include <fgfs_fdm_in.hpp>
 #include <manual_flight_controller.hpp>
-#include <sl_controller.hpp>
+#include "sl_controller.hpp"
+#include <telnet_control_sink.hpp>
+#include <fgfs_ctrls_out.hpp>
+#include <async_control_sink.hpp>
+#include <fgfs_property_mirror.hpp>
 #include <flight_mode.hpp>
 #include <joystick.hpp>
 #include <sensors.hpp>
+#include <event_loop.hpp>
+#include <latency_histogram.hpp>
+#include <flight_recorder.hpp>
+#include <fdm_frame_clock.hpp>
+#include <fdm_predictor.hpp>
+#include <fixed_rate_scheduler.hpp>
 
 #include <quan/three_d/vect.hpp>
 #include <quan/three_d/quat.hpp>
@@ -49,10 +62,14 @@ namespace {
    QUAN_QUANTITY_LITERAL(time,ms);
    QUAN_QUANTITY_LITERAL(time,s);
 
-   quan::time::ms constexpr time_step = 100_ms;
+   /**
+    * @brief fdm period set by --native-fdm in exec_flightgear.sh.
+    * Only used until fdm_frame_clock has measured the real period
+    **/
+   quan::time::ms constexpr nominal_fdm_period = 100_ms;
 
    // indirect system floating point type e.g for microcontrollers rpi etc
-   using float_type = quan::quantity_traits::default_value_type;
+   using float_type = control_float_type;
  
    /**
    *  @brief Display some FDM data to stdout to show what is what
@@ -113,53 +130,56 @@ namespace {
       return true;
    }
 
-   int frame_count = 0;
-   uint32_t cur_unix_time = 0;
-
-//
-//   quan::time::ms get_time_step1(autoconv_FGNetFDM const & fdm)
-//   {
-//      uint32_t const unix_time = fdm.cur_time.get();
-//      uint32_t diff = unix_time - cur_unix_time;
-//      //fprintf(stdout, "utd = %u\n",);
-//      cur_unix_time = unix_time;
-//
-//      if (diff == 0){
-//          ++frame_count;
-//      }else{
-//          ++frame_count;
-//         fprintf(stdout,"fc = %u\n",frame_count);
-//          frame_count = 0U;
-//      }
-////      if ( cur_unix_time == 0){
-////         fprintf(stdout,"xx 0\n");
-////         cur_unix_time = unix_time;
-////         frame_count = -1;
-////      }else{
-////         if ( cur_unix_time == unix_time){
-////             fprintf(stdout,"xx 1\n");
-////             ++frame_count;
-////         }else{
-////            if ( frame_count == -1){
-////               fprintf(stdout,"xx 2\n");
-////               frame_count = 0;
-////            }else{
-////               if ( frame_count > 0){
-////                 // fprintf(stdout,"\ncfc = %u\n", frame_count );
-////                  fprintf(stdout,"xx 3\n");
-////                  calced_frame_period = ((unix_time - cur_unix_time) * 1000_ms)/ frame_count;
-////                  cur_unix_time = unix_time;
-////                  frame_count = 0;
-////               }else{
-////                 fprintf(stdout,"xx 4\n");
-////               }
-////            }
-////         }
-////      }
-//    //  fprintf(stdout,"\ncalced fp = %f\n", calced_frame_period.numeric_value() );
-//      fflush(stdout);
-//      return calced_frame_period;
-//   }
+   /**
+    * @brief flight log ring size. 4 hours of fdm at 50 Hz ( about 300 MB)
+    **/
+   constexpr uint64_t max_log_records = 4 * 3600 * 50;
+
+   /**
+    * @brief value of an option on the command line e.g -r <path>
+    * @return the value or nullptr if the option isnt present
+    **/
+   const char* get_option(int argc, const char* argv[], const char* option)
+   {
+      for ( int i = 1; i < argc - 1; ++i){
+         if ( strcmp(argv[i],option) == 0){
+            return argv[i + 1];
+         }
+      }
+      return nullptr;
+   }
+
+   /**
+    * @brief true if a flag option e.g -a is on the command line
+    **/
+   bool has_option(int argc, const char* argv[], const char* option)
+   {
+      for ( int i = 1; i < argc; ++i){
+         if ( strcmp(argv[i],option) == 0){
+            return true;
+         }
+      }
+      return false;
+   }
+
+   /**
+    * @brief how controls are sent to FlightGear, from -s ctrls|telnet on the command line
+    * ctrls sends one FGNetCtrls datagram per frame to the --native-ctrls port in exec_flightgear.sh
+    * telnet ( the default) sends a property set for each control that changed
+    **/
+   std::unique_ptr<abc_control_sink> make_control_sink(int argc, const char* argv[], fgfs_telnet const & telnet)
+   {
+      const char* const sink = get_option(argc,argv,"-s");
+      if ( (sink == nullptr) || (strcmp(sink,"telnet") == 0) ){
+         fprintf(stdout,"sending controls via telnet\n");
+         return std::make_unique<telnet_control_sink>(telnet);
+      }
+      if ( strcmp(sink,"ctrls") == 0){
+         fprintf(stdout,"sending controls via native ctrls\n");
+         return std::make_unique<fgfs_ctrls_out>("localhost",fgfs_ctrls_out::default_port);
+      }
+      throw("straightnlevel/-s option must be ctrls or telnet");
+   }
 }
 
 int main(const int argc, const char *argv[])
@@ -192,8 +212,28 @@ int main(const int argc, const char *argv[])
              * Have joystick input, fdm and telnet so...
              * Create manual controller and plug in telnet and joystick. 
              **/
-            manual_flight_controller mfc(telnet_out,"/dev/input/js0");
-            sl_controller slfc{telnet_out};
+            std::unique_ptr<abc_control_sink> const control_sink = make_control_sink(argc,argv,telnet_out);
+            /**
+             * with -a controls are sent from another thread, 
+             * so a slow FlightGear can't stall the control loop
+             **/
+            std::unique_ptr<async_control_sink> async_sink;
+            if ( has_option(argc,argv,"-a")){
+               async_sink = std::make_unique<async_control_sink>(*control_sink);
+               async_sink->start();
+               fprintf(stdout,"sending controls asynchronously\n");
+            }
+            abc_control_sink & sink = async_sink ? static_cast<abc_control_sink&>(*async_sink) : *control_sink;
+            manual_flight_controller mfc(sink,"/dev/input/js0");
+            sl_controller slfc{sink};
+
+            std::unique_ptr<flight_recorder> recorder;
+            if ( const char* const log_path = get_option(argc,argv,"-r")){
+               recorder = std::make_unique<flight_recorder>(log_path,max_log_records,max_log_records);
+               mfc.set_recorder(recorder.get());
+               slfc.set_recorder(recorder.get());
+               fprintf(stdout,"recording flight to %s\n",log_path);
+            }
 
             flight_mode cur_flight_mode = flight_mode::Manual;
             abc_flight_controller* fc = &mfc;
@@ -202,38 +242,157 @@ int main(const int argc, const char *argv[])
 
             // OK start control loop.
             // Joystick should now be controlling aircraft in FlightGear
-            for (;;){
-               auto const now = std::chrono::steady_clock::now();
-  
-            //   get_time_step1(fdm_in.get_fdm());
-             //  std::cout << "\nfg time step = " << time_step <<'\n';
-               /**
-                 * @brief We should run at Flightgear fdm update rate, set on cmdline in --telnet... to 30 times a sec
-                 * Here is the elastic, if FlightGear is late
-               **/
-               if( fdm_in.poll(10.0_s)){
-                  fdm_in.update();
-                //  output_fdm(fdm_in.get_fdm());
-                  // switch flight mode
-                  auto fm = get_flight_mode();
-                  if (fm != cur_flight_mode){
-                     cur_flight_mode = fm;
-                     if(fm == flight_mode::Manual) {
-                        fc = &mfc;
-                     }else{
-                        fc = &slfc;
-                     }
+            event_loop loop;
+
+            // kill -USR1 <pid> to see fdm path latencies while running
+            dump_latency_histograms_on_signal(SIGUSR1);
+
+            /**
+             * with -x <Hz> the controller also runs from a timer at that rate between fdm packets,
+             * on the fdm state extrapolated from the last packet
+             **/
+            const char* const fast_rate_option = get_option(argc,argv,"-x");
+            double const fast_rate_Hz = (fast_rate_option != nullptr) ? atof(fast_rate_option) : 0.0;
+            if ( (fast_rate_option != nullptr) && !(fast_rate_Hz > 0.0)){
+               throw("straightnlevel/-x option must be a rate in Hz");
+            }
+            bool fdm_received = false;
+            fdm_frame_clock frame_clock{nominal_fdm_period};
+            latency_histogram fdm_phase_error{"fdm phase error"};
+            fdm_predictor predictor;
+            fdm_state fdm_now;
+            int64_t last_update_ns = 0;
+
+            /**
+             * @brief switch flight mode if requested and update the current controller
+             * The time step is the time since the last update, or the fdm period if only run per packet
+             **/
+            auto update_controller = [&](fdm_state const & fdm){
+               auto fm = get_flight_mode();
+               if (fm != cur_flight_mode){
+                  cur_flight_mode = fm;
+                  if(fm == flight_mode::Manual) {
+                     fc = &mfc;
+                  }else{
+                     fc = &slfc;
                   }
-                  if (!fc->update(fdm_in.get_fdm(),time_step)){
-                     fprintf(stdout,"flight controller update failed - quitting\n");
-                     break;
+               }
+               quan::time::ms time_step = frame_clock.get_period();
+               int64_t const now = get_time_ns(CLOCK_MONOTONIC);
+               if ( (fast_rate_Hz > 0.0) && (last_update_ns != 0) ){
+                  time_step = quan::time::ms{(now - last_update_ns) / 1.e6};
+               }
+               last_update_ns = now;
+               if (!fc->update(fdm,time_step)){
+                  fprintf(stdout,"flight controller update failed - quitting\n");
+                  loop.stop();
+               }
+            };
+
+            /**
+              * @brief We run at Flightgear fdm update rate, set on cmdline in --native-fdm...
+              * The controller is updated as soon as each fdm packet arrives
+            **/
+            loop.add_fd(fdm_in.get_fd(),[&]{
+               if ( !fdm_in.update_latest()){
+                  return;
+               }
+               int64_t const arrival_time = to_ns(fdm_in.get_arrival_time());
+               record_latency(latency_stage::Arrival, get_time_ns(CLOCK_REALTIME) - arrival_time);
+               fdm_received = true;
+               // the controller time step is the measured fdm period, not the rate asked for on the command line
+               frame_clock.update(fdm_in.get_arrival_time(),fdm_in.get_fdm().cur_time.get());
+               if ( frame_clock.is_locked()){
+                  int64_t const phase_error = frame_clock.get_phase_error_ns();
+                  fdm_phase_error.record( (phase_error < 0) ? -phase_error : phase_error);
+               }
+               if ( recorder){
+                  recorder->record_fdm(fdm_in.get_fdm(),fdm_in.get_arrival_time());
+               }
+             //  output_fdm(fdm_in.get_fdm());
+               int64_t const t0 = get_time_ns(CLOCK_MONOTONIC);
+               decode_fdm(fdm_in.get_fdm(),fdm_now);
+               record_latency(latency_stage::Decode, get_time_ns(CLOCK_MONOTONIC) - t0);
+               predictor.reset(fdm_now);
+               update_controller(fdm_now);
+               record_latency(latency_stage::EndToEnd, get_time_ns(CLOCK_REALTIME) - arrival_time);
+               service_latency_dump_request(stdout);
+            });
+
+            std::unique_ptr<fixed_rate_scheduler> fast_scheduler;
+            if ( fast_rate_Hz > 0.0){
+               fast_scheduler = std::make_unique<fixed_rate_scheduler>("controller",quan::time::us{1.e6 / fast_rate_Hz});
+               loop.add_timer(*fast_scheduler,[&](uint64_t){
+                  if ( last_update_ns == 0){
+                     return;
                   }
-               }else{
-                  fprintf(stdout,"FlightGear FDM update more than 10 s late");
+                  int64_t const since_fdm_ns = get_time_ns(CLOCK_REALTIME) - to_ns(fdm_in.get_arrival_time());
+                  // dont extrapolate far past a missing packet
+                  int64_t const max_extrapolation_ns = static_cast<int64_t>(frame_clock.get_period().numeric_value() * 2.e6);
+                  if ( since_fdm_ns < max_extrapolation_ns){
+                     update_controller(predictor.predict(quan::time::us{ (since_fdm_ns > 0) ? since_fdm_ns / 1.e3 : 0.0}));
+                  }
+               });
+               fprintf(stdout,"running controller at %f Hz\n",fast_rate_Hz);
+            }
+
+            // flight mode key presses. The terminal stays in raw mode until exit
+            int const keyboard_fd = init_keyboard();
+            loop.add_fd(keyboard_fd,[&]{
+               if ( !process_keyboard_input()){
+                  loop.remove_fd(keyboard_fd);
+               }
+            });
+
+            // FlightGear pushes the frame rate whenever it changes
+            int32_t fgfs_frame_rate = 0;
+            fgfs_property_mirror mirror{telnet_out};
+            mirror.add(fgfs_prop::FrameRate,fgfs_frame_rate);
+            if ( !mirror.subscribe()){
+               throw "subscribe to FlightGear properties";
+            }
+
+            // apply pushed property values and discard any other telnet replies so the socket buffer doesnt fill
+            loop.add_fd(telnet_out.get_fd(),[&]{
+               if ( !mirror.process_input()){
+                  fprintf(stdout,"FlightGear telnet closed - quitting\n");
+                  loop.stop();
+               }
+            });
+
+            // Here is the elastic, if FlightGear is late
+            loop.add_timer(10_s,[&](uint64_t){
+               if ( !fdm_received){
+                  fprintf(stdout,"FlightGear FDM update more than 10 s late\n");
                }
-               // wake up just before the next fdm packet is available from FlightGear (hopefully!)
-               //@todo wakeup on SIGIO ?, 
-               std::this_thread::sleep_until(now + 19ms);
+               fdm_received = false;
+            });
+
+            loop.run();
+
+            dump_latency_histograms(stdout);
+            fdm_phase_error.dump(stdout);
+            if ( fast_scheduler){
+               fast_scheduler->dump(stdout);
+            }
+            fprintf(stdout,"fdm period = %f ms ( %s), %u frames per sim second, %llu lost\n",
+               frame_clock.get_period().numeric_value(),
+               frame_clock.is_locked() ? "locked" : "not locked",
+               frame_clock.get_frames_per_sim_second(),
+               static_cast<unsigned long long>(frame_clock.get_num_lost())
+            );
+            fprintf(stdout,"FlightGear frame rate = %d Hz ( %llu updates)\n",
+               static_cast<int>(fgfs_frame_rate),
+               static_cast<unsigned long long>(mirror.get_num_updates())
+            );
+            if ( async_sink){
+               async_sink->stop();
+               fprintf(stdout,"async controls : sent = %llu, failed = %llu, dropped = %llu, queue depth = %u\n",
+                  static_cast<unsigned long long>(async_sink->get_num_sent()),
+                  static_cast<unsigned long long>(async_sink->get_num_send_failures()),
+                  static_cast<unsigned long long>(async_sink->get_num_dropped()),
+                  async_sink->get_queue_depth()
+               );
             }
             return EXIT_SUCCESS;
          } catch (const char s[]) {
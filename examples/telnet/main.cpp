@@ -4,14 +4,15 @@
 #include <cstring>
 #include <cstdlib>
 #include <cassert>
+#include <unistd.h>
 
-#include <chrono>
-#include <thread>
 #include <iostream>
 
 #include <quan/fs/get_file_dir.hpp>
+#include <csignal>
 #include "fgfs_telnet.hpp"
 #include "joystick.hpp"
+#include <fixed_rate_scheduler.hpp>
 
 /**
 *  
@@ -19,6 +20,8 @@
 
 namespace {
 
+   QUAN_QUANTITY_LITERAL(time,ms)
+
   /**
     * @brief Try starting telnet. Keep trying for 20 s
     * @return true if telnet started
@@ -41,9 +44,6 @@ namespace {
    void stop_telnet();
 }
 
-/// @brief required for chrono literals to be found
-using namespace std::chrono_literals;
-
 int main(const int argc, const char *argv[])
 {
    int pid = fork();
@@ -63,10 +63,17 @@ int main(const int argc, const char *argv[])
                return 1;
             }
 
+            // kill -USR1 <pid> to see the loop timing
+            dump_latency_histograms_on_signal(SIGUSR1);
+
+            fixed_rate_scheduler scheduler{"telnet loop",20_ms};
             for (;;){
-               auto const now = std::chrono::steady_clock::now();
+               js.update();
                set_controls(get_telnet(),js);
-               std::this_thread::sleep_until(now + 20ms);
+               if ( take_latency_dump_request()){
+                  scheduler.dump(stdout);
+               }
+               scheduler.wait();
             }
 
             return EXIT_SUCCESS;
@@ -96,10 +103,10 @@ namespace {
 
    void set_controls(fgfs_telnet & telnet, joystick_t const & js )
    {
-      telnet.set("/controls/flight/aileron",js.roll.get());
-      telnet.set("/controls/flight/elevator",js.pitch.get());
-      telnet.set("/controls/flight/rudder",js.yaw.get());
-      telnet.set("/controls/engines/engine[0]/throttle", js.throttle.get());
+      telnet.set(fgfs_prop::Aileron,js.roll.get());
+      telnet.set(fgfs_prop::Elevator,js.pitch.get());
+      telnet.set(fgfs_prop::Rudder,js.yaw.get());
+      telnet.set(fgfs_prop::Throttle, js.throttle.get());
    }
 }
 
@@ -127,15 +134,16 @@ namespace{
       if ( ptelnet){
          return true;
       }
-      auto const start = std::chrono::steady_clock::now();
-      while ( (std::chrono::steady_clock::now() - start) < 20s){
+      int64_t const start_ns = get_time_ns(CLOCK_MONOTONIC);
+      // 20 s
+      while ( (get_time_ns(CLOCK_MONOTONIC) - start_ns) < 20 * 1000000000LL){
          try {
             ptelnet = new fgfs_telnet("localhost",5501);
             break;
          }catch(const char s[]){
             assert(ptelnet == nullptr);
             std::cout << "Waiting for flightgear to start...\n";
-            std::this_thread::sleep_for(2s);
+            ::sleep(2);
          }
       }
       return ptelnet != nullptr;
@@ -0,0 +1,165 @@
+
+#include <cstdio>
+#include <cerrno>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+
+#include <async_control_sink.hpp>
+
+namespace {
+
+   /// @brief how often the sender checks if it should stop
+   constexpr int stop_check_period_ms = 100;
+   /// @brief wait before retrying after the downstream sink failed
+   constexpr int retry_period_ms = 10;
+
+   void signal_event(int fd)
+   {
+      uint64_t const one = 1;
+      // only fails if the count would overflow, in which case it is already signalled
+      ssize_t const n = ::write(fd, &one, sizeof(one));
+      (void)n;
+   }
+}
+
+async_control_sink::async_control_sink(abc_control_sink & downstream)
+: m_downstream{downstream},
+  m_pending{0},
+  m_num_sent{0},
+  m_num_send_failures{0},
+  m_event_fd{::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)},
+  m_running{false}
+{
+   if ( m_event_fd < 0){
+      throw("async_control_sink/eventfd");
+   }
+   for ( uint32_t i = 0; i < num_slots; ++i){
+      m_values[i].store(0,std::memory_order_relaxed);
+      m_num_dropped[i].store(0,std::memory_order_relaxed);
+   }
+}
+
+async_control_sink::~async_control_sink()
+{
+   stop();
+   ::close(m_event_fd);
+}
+
+void async_control_sink::start()
+{
+   if ( !m_running.exchange(true)){
+      m_thread = std::thread{[this]{ run();}};
+   }
+}
+
+void async_control_sink::stop()
+{
+   m_running = false;
+   if ( m_thread.joinable()){
+      signal_event(m_event_fd);
+      m_thread.join();
+   }
+}
+
+bool async_control_sink::set_control(FlightDimension d, float_type const & value)
+{
+   uint32_t const slot = static_cast<uint32_t>(d);
+   if ( slot >= num_slots){
+      return false;
+   }
+   m_values[slot].store(value,std::memory_order_relaxed);
+   uint32_t const bit = 1U << slot;
+   // release so the sender sees the value when it sees the bit
+   uint32_t const prev = m_pending.fetch_or(bit,std::memory_order_release);
+   if ( (prev & bit) != 0){
+      m_num_dropped[slot].fetch_add(1,std::memory_order_relaxed);
+   }
+   if ( prev == 0){
+      signal_event(m_event_fd);
+   }
+   return true;
+}
+
+uint32_t async_control_sink::get_queue_depth() const
+{
+   return static_cast<uint32_t>(__builtin_popcount(m_pending.load(std::memory_order_relaxed)));
+}
+
+uint64_t async_control_sink::get_num_dropped(FlightDimension d) const
+{
+   uint32_t const slot = static_cast<uint32_t>(d);
+   return (slot < num_slots) ? m_num_dropped[slot].load(std::memory_order_relaxed) : 0;
+}
+
+uint64_t async_control_sink::get_num_dropped() const
+{
+   uint64_t sum = 0;
+   for ( auto const & n : m_num_dropped){
+      sum += n.load(std::memory_order_relaxed);
+   }
+   return sum;
+}
+
+void async_control_sink::wait_for_pending(int timeout_ms)
+{
+   pollfd pfd{m_event_fd,POLLIN,0};
+   if ( ::poll(&pfd, 1, timeout_ms) > 0){
+      // reset the eventfd. The pending bits say what to send
+      uint64_t count;
+      ssize_t const n = ::read(m_event_fd, &count, sizeof(count));
+      (void)n;
+   }
+}
+
+bool async_control_sink::send(uint32_t pending)
+{
+   try{
+      if ( !m_downstream.begin_frame()){
+         return false;
+      }
+      for ( uint32_t slot = 0; slot < num_slots; ++slot){
+         if ( (pending & (1U << slot)) != 0){
+            float_type const value = m_values[slot].load(std::memory_order_relaxed);
+            if ( !m_downstream.set_control(static_cast<FlightDimension>(slot),value)){
+               return false;
+            }
+         }
+      }
+      return m_downstream.end_frame();
+   }catch(...){
+      return false;
+   }
+}
+
+void async_control_sink::run()
+{
+   // slots whose last send failed. Kept here rather than marked pending again,
+   // so a newer value set meanwhile doesnt count the failed one as dropped too
+   uint32_t retry = 0;
+   while ( m_running.load(std::memory_order_relaxed)){
+      uint32_t const pending = m_pending.exchange(0,std::memory_order_acquire) | retry;
+      if ( pending == 0){
+         wait_for_pending(stop_check_period_ms);
+         continue;
+      }
+      if ( send(pending)){
+         m_num_sent.fetch_add(1,std::memory_order_relaxed);
+         retry = 0;
+      }else{
+         // any newer value set meanwhile is already in the slot
+         retry = pending;
+         m_num_send_failures.fetch_add(1,std::memory_order_relaxed);
+         wait_for_pending(retry_period_ms);
+      }
+   }
+   // send what was set before stop() once, so the last frame isnt lost
+   uint32_t const pending = m_pending.exchange(0,std::memory_order_acquire) | retry;
+   if ( pending != 0){
+      if ( send(pending)){
+         m_num_sent.fetch_add(1,std::memory_order_relaxed);
+      }else{
+         m_num_send_failures.fetch_add(1,std::memory_order_relaxed);
+      }
+   }
+}
@@ -0,0 +1,178 @@
+
+#include <cstdio>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+#include <event_loop.hpp>
+#include <fixed_rate_scheduler.hpp>
+
+event_loop::event_loop()
+: m_epoll_fd{::epoll_create1(EPOLL_CLOEXEC)},
+  m_running{false},
+  m_dispatching{false}
+{
+   if ( m_epoll_fd < 0){
+      throw ("event_loop/epoll_create");
+   }
+}
+
+event_loop::~event_loop()
+{
+   for ( auto & h : m_handlers){
+      if ( (h.fd >= 0) && h.is_timer){
+         ::close(h.fd);
+      }
+   }
+   ::close(m_epoll_fd);
+}
+
+uint32_t event_loop::add_handler(int fd)
+{
+   for ( uint32_t i = 0; i < max_handlers; ++i){
+      if ( (m_handlers[i].fd == -1) && !m_handlers[i].release_pending){
+         epoll_event ev{};
+         ev.events = EPOLLIN;
+         ev.data.u32 = i;
+         if (::epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0){
+            throw ("event_loop/epoll_ctl add");
+         }
+         m_handlers[i].fd = fd;
+         return i;
+      }
+   }
+   throw ("event_loop/add : too many handlers");
+}
+
+void event_loop::add_fd(int fd, fd_callback_t const & cb)
+{
+   auto & h = m_handlers[add_handler(fd)];
+   h.is_timer = false;
+   h.on_readable = cb;
+}
+
+int event_loop::add_timerfd(itimerspec const & spec, int flags, timer_callback_t const & cb)
+{
+   int const fd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+   if ( fd < 0){
+      throw ("event_loop/timerfd_create");
+   }
+   if ( ::timerfd_settime(fd, flags, &spec, nullptr) < 0){
+      ::close(fd);
+      throw ("event_loop/timerfd_settime");
+   }
+   try{
+      auto & h = m_handlers[add_handler(fd)];
+      h.is_timer = true;
+      h.on_timer = cb;
+   }catch(...){
+      ::close(fd);
+      throw;
+   }
+   return fd;
+}
+
+int event_loop::add_timer(quan::time::us const & period, timer_callback_t const & cb)
+{
+   int64_t const period_ns = static_cast<int64_t>(period.numeric_value() * 1000);
+   itimerspec spec{};
+   spec.it_interval.tv_sec = period_ns / 1000000000;
+   spec.it_interval.tv_nsec = period_ns % 1000000000;
+   spec.it_value = spec.it_interval;
+   return add_timerfd(spec, 0, cb);
+}
+
+int event_loop::add_timer(fixed_rate_scheduler & scheduler, timer_callback_t const & cb)
+{
+   scheduler.start();
+   int64_t const period_ns = scheduler.get_period_ns();
+   itimerspec spec{};
+   spec.it_interval.tv_sec = period_ns / 1000000000;
+   spec.it_interval.tv_nsec = period_ns % 1000000000;
+   // absolute, so the timer and the scheduler agree on the deadlines
+   spec.it_value = scheduler.get_next_deadline();
+   return add_timerfd(spec, TFD_TIMER_ABSTIME, [&scheduler,cb](uint64_t expirations){
+      scheduler.on_expired(expirations);
+      cb(expirations);
+   });
+}
+
+void event_loop::remove_fd(int fd)
+{
+   for ( auto & h : m_handlers){
+      if ( h.fd == fd){
+         ::epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+         if ( h.is_timer){
+            ::close(fd);
+         }
+         if ( m_dispatching){
+            // the running callback may be this one, so dont destroy it yet
+            h.fd = -1;
+            h.release_pending = true;
+         }else{
+            h = handler{};
+         }
+         return;
+      }
+   }
+}
+
+void event_loop::release_removed_handlers()
+{
+   for ( auto & h : m_handlers){
+      if ( h.release_pending){
+         h = handler{};
+      }
+   }
+}
+
+int event_loop::wait_and_dispatch(int timeout_ms)
+{
+   epoll_event events[max_handlers];
+   int const n = ::epoll_wait(m_epoll_fd, events, max_handlers, timeout_ms);
+   if ( n < 0){
+      if ( errno == EINTR){
+         return 0;
+      }
+      throw ("event_loop/epoll_wait");
+   }
+   m_dispatching = true;
+   try{
+      for ( int i = 0; i < n; ++i){
+         auto & h = m_handlers[events[i].data.u32];
+         if ( h.fd == -1){
+            // removed by an earlier callback
+            continue;
+         }
+         if ( h.is_timer){
+            uint64_t expirations = 0;
+            if ( ::read(h.fd, &expirations, sizeof(expirations)) == sizeof(expirations)){
+               h.on_timer(expirations);
+            }
+         }else{
+            h.on_readable();
+         }
+      }
+   }catch(...){
+      m_dispatching = false;
+      release_removed_handlers();
+      throw;
+   }
+   m_dispatching = false;
+   release_removed_handlers();
+   return n;
+}
+
+void event_loop::run()
+{
+   m_running = true;
+   while (m_running){
+      wait_and_dispatch(-1);
+   }
+}
+
+int event_loop::run_once(quan::time::ms const & timeout)
+{
+   return wait_and_dispatch(static_cast<int>(timeout.numeric_value()));
+}
@@ -0,0 +1,100 @@
+
+#include <cmath>
+#include <fdm_frame_clock.hpp>
+#include <latency_histogram.hpp>
+
+namespace {
+
+   /// @brief phase correction gain
+   constexpr double phase_gain = 0.1;
+   /**
+    * @brief period correction gain. With phase_gain the loop is critically damped, so a period step
+    * settles within 2% in about 110 frames without overshoot. The poles are the roots of
+    * z^2 - (2 - phase_gain - period_gain) z + (1 - phase_gain), which are real for period_gain <= 0.00263
+   **/
+   constexpr double period_gain = 0.0026;
+   /// @brief smoothing of the mean absolute error used to decide lock
+   constexpr double error_filter = 0.05;
+   /// @brief locked when the mean error is less than this fraction of the period
+   constexpr double lock_threshold = 0.1;
+   constexpr uint64_t min_frames_to_lock = 16;
+}
+
+fdm_frame_clock::fdm_frame_clock(quan::time::ms const & nominal_period)
+: m_nominal_period_ns{nominal_period.numeric_value() * 1.e6},
+  m_period_ns{m_nominal_period_ns},
+  m_predicted_ns{0},
+  m_phase_error_ns{0},
+  m_mean_abs_error_ns{m_nominal_period_ns},
+  m_num_frames{0},
+  m_num_lost{0},
+  m_cur_time{0},
+  m_frames_this_sim_second{0},
+  m_frames_per_sim_second{0}
+{
+   if ( m_nominal_period_ns <= 0.0){
+      throw("fdm_frame_clock/bad nominal period");
+   }
+}
+
+void fdm_frame_clock::update_sim_second(uint32_t cur_time)
+{
+   if ( cur_time == m_cur_time){
+      ++m_frames_this_sim_second;
+      return;
+   }
+   // only a count over one whole second is a measurement. The first count is a partial second
+   if ( (m_cur_time != 0) && (cur_time == m_cur_time + 1) && (m_num_frames > m_frames_this_sim_second) ){
+      m_frames_per_sim_second = m_frames_this_sim_second;
+   }
+   m_cur_time = cur_time;
+   m_frames_this_sim_second = 1;
+}
+
+void fdm_frame_clock::constrain_period()
+{
+   double const reference = (m_frames_per_sim_second > 0)
+      ? 1.e9 / m_frames_per_sim_second
+      : m_nominal_period_ns;
+   if ( m_period_ns < reference * 0.5){
+      m_period_ns = reference * 0.5;
+   }else if ( m_period_ns > reference * 2.0){
+      m_period_ns = reference * 2.0;
+   }
+}
+
+void fdm_frame_clock::update(timespec const & arrival_time, uint32_t cur_time)
+{
+   int64_t const arrival_ns = to_ns(arrival_time);
+   update_sim_second(cur_time);
+
+   if ( m_num_frames++ == 0){
+      m_predicted_ns = arrival_ns + static_cast<int64_t>(m_period_ns);
+      return;
+   }
+
+   double error = static_cast<double>(arrival_ns - m_predicted_ns);
+   // a whole number of periods late means packets were lost, not that the clock is wrong
+   if ( error > m_period_ns * 0.5){
+      double const periods = std::floor(error / m_period_ns + 0.5);
+      m_num_lost += static_cast<uint64_t>(periods);
+      m_predicted_ns += static_cast<int64_t>(periods * m_period_ns);
+      error = static_cast<double>(arrival_ns - m_predicted_ns);
+   }
+   m_phase_error_ns = static_cast<int64_t>(error);
+   m_mean_abs_error_ns += (std::fabs(error) - m_mean_abs_error_ns) * error_filter;
+
+   m_period_ns += error * period_gain;
+   constrain_period();
+   m_predicted_ns += static_cast<int64_t>(error * phase_gain + m_period_ns);
+}
+
+bool fdm_frame_clock::is_locked() const
+{
+   return (m_num_frames >= min_frames_to_lock) && (m_mean_abs_error_ns < m_period_ns * lock_threshold);
+}
+
+quan::time::ms fdm_frame_clock::get_period() const
+{
+   return quan::time::ms{ (is_locked() ? m_period_ns : m_nominal_period_ns) / 1.e6};
+}
@@ -0,0 +1,184 @@
+
+#include <cmath>
+#include <fdm_predictor.hpp>
+
+namespace {
+
+   constexpr float pi = 3.14159265f;
+   constexpr float gravity = 9.80665f;
+   /// @brief WGS84 equatorial radius. Good enough for the distance covered between packets
+   constexpr double earth_radius = 6378137.0;
+
+   /// @brief quaternion w,x,y,z from euler angles roll x, pitch y, yaw z ( z-y-x order)
+   void quat_from_euler(float roll, float pitch, float yaw, float q[4])
+   {
+      float const cr = std::cos(roll * 0.5f);
+      float const sr = std::sin(roll * 0.5f);
+      float const cp = std::cos(pitch * 0.5f);
+      float const sp = std::sin(pitch * 0.5f);
+      float const cy = std::cos(yaw * 0.5f);
+      float const sy = std::sin(yaw * 0.5f);
+      q[0] = cr * cp * cy + sr * sp * sy;
+      q[1] = sr * cp * cy - cr * sp * sy;
+      q[2] = cr * sp * cy + sr * cp * sy;
+      q[3] = cr * cp * sy - sr * sp * cy;
+   }
+
+   /// @brief r = a * b
+   void hamilton_product(float const a[4], float const b[4], float r[4])
+   {
+      r[0] = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+      r[1] = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+      r[2] = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+      r[3] = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+   }
+
+   /// @brief rotation matrix body to NED from a unit quaternion
+   void rotation_from_quat(float const q[4], float m[3][3])
+   {
+      float const w = q[0], x = q[1], y = q[2], z = q[3];
+      m[0][0] = 1.f - 2.f * (y * y + z * z);
+      m[0][1] = 2.f * (x * y - w * z);
+      m[0][2] = 2.f * (x * z + w * y);
+      m[1][0] = 2.f * (x * y + w * z);
+      m[1][1] = 1.f - 2.f * (x * x + z * z);
+      m[1][2] = 2.f * (y * z - w * x);
+      m[2][0] = 2.f * (x * z - w * y);
+      m[2][1] = 2.f * (y * z + w * x);
+      m[2][2] = 1.f - 2.f * (x * x + y * y);
+   }
+
+   /// @brief angle in range -pi to pi
+   float wrap_pi(float a)
+   {
+      while ( a > pi){
+         a -= 2.f * pi;
+      }
+      while ( a <= -pi){
+         a += 2.f * pi;
+      }
+      return a;
+   }
+
+   fdm_state::rad<> rad(float v) { return fdm_state::rad<>{v};}
+}
+
+fdm_predictor::fdm_predictor()
+: m_base{},
+  m_predicted{},
+  m_q0{1.f,0.f,0.f,0.f},
+  m_body_rate{0.f,0.f,0.f},
+  m_body_rate_mag{0.f},
+  m_accel_ned{0.f,0.f,0.f},
+  m_velocity_body_ned{0.f,0.f,0.f},
+  m_rad_per_m_north{0.0},
+  m_rad_per_m_east{0.0}
+{}
+
+void fdm_predictor::reset(fdm_state const & fdm)
+{
+   m_base = fdm;
+   m_predicted = fdm;
+
+   float const phi = fdm.attitude.x.numeric_value();
+   float const theta = fdm.attitude.y.numeric_value();
+   float const psi = fdm.attitude.z.numeric_value();
+   quat_from_euler(phi,theta,psi,m_q0);
+
+   // euler rates to body rates
+   float const phidot = fdm.attitude_rate.x.numeric_value().numeric_value();
+   float const thetadot = fdm.attitude_rate.y.numeric_value().numeric_value();
+   float const psidot = fdm.attitude_rate.z.numeric_value().numeric_value();
+   float const sin_phi = std::sin(phi);
+   float const cos_phi = std::cos(phi);
+   float const sin_theta = std::sin(theta);
+   float const cos_theta = std::cos(theta);
+   m_body_rate[0] = phidot - psidot * sin_theta;
+   m_body_rate[1] = thetadot * cos_phi + psidot * sin_phi * cos_theta;
+   m_body_rate[2] = psidot * cos_phi * cos_theta - thetadot * sin_phi;
+   m_body_rate_mag = std::sqrt(m_body_rate[0] * m_body_rate[0] 
+      + m_body_rate[1] * m_body_rate[1] + m_body_rate[2] * m_body_rate[2]);
+
+   // pilot accelerations are specific force, so add gravity back to get the NED acceleration
+   float r[3][3];
+   rotation_from_quat(m_q0,r);
+   float const a[3] = {
+      fdm.accel_body.x.numeric_value(),
+      fdm.accel_body.y.numeric_value(),
+      fdm.accel_body.z.numeric_value()
+   };
+   float const vb[3] = {
+      fdm.velocity_body.x.numeric_value(),
+      fdm.velocity_body.y.numeric_value(),
+      fdm.velocity_body.z.numeric_value()
+   };
+   for ( int i = 0; i < 3; ++i){
+      m_accel_ned[i] = r[i][0] * a[0] + r[i][1] * a[1] + r[i][2] * a[2];
+      m_velocity_body_ned[i] = r[i][0] * vb[0] + r[i][1] * vb[1] + r[i][2] * vb[2];
+   }
+   m_accel_ned[2] += gravity;
+
+   double const radius = earth_radius + fdm.altitude.numeric_value();
+   m_rad_per_m_north = 1.0 / radius;
+   double const cos_lat = std::cos(fdm.latitude.numeric_value());
+   m_rad_per_m_east = (std::fabs(cos_lat) > 1.e-6) ? 1.0 / (radius * cos_lat) : 0.0;
+}
+
+fdm_state const & fdm_predictor::predict(quan::time::us const & dt)
+{
+   float const t = static_cast<float>(dt.numeric_value() * 1.e-6);
+
+   // attitude, rotated about the body rate axis by the angle turned since the packet
+   float q[4];
+   float const half_angle = 0.5f * m_body_rate_mag * t;
+   if ( half_angle > 1.e-6f){
+      float const s = std::sin(half_angle) / m_body_rate_mag;
+      float const dq[4] = {std::cos(half_angle), m_body_rate[0] * s, m_body_rate[1] * s, m_body_rate[2] * s};
+      hamilton_product(m_q0,dq,q);
+   }else{
+      q[0] = m_q0[0]; q[1] = m_q0[1]; q[2] = m_q0[2]; q[3] = m_q0[3];
+   }
+   float const sin_pitch = 2.f * (q[0] * q[2] - q[3] * q[1]);
+   float const roll = std::atan2(2.f * (q[0] * q[1] + q[2] * q[3]), 1.f - 2.f * (q[1] * q[1] + q[2] * q[2]));
+   float const pitch = std::asin( (sin_pitch > 1.f) ? 1.f : ((sin_pitch < -1.f) ? -1.f : sin_pitch) );
+   float const yaw = std::atan2(2.f * (q[0] * q[3] + q[1] * q[2]), 1.f - 2.f * (q[2] * q[2] + q[3] * q[3]));
+   // keep the angle range FlightGear used in the packet e.g heading 0 to 2 pi
+   float const base_roll = m_base.attitude.x.numeric_value();
+   float const base_yaw = m_base.attitude.z.numeric_value();
+   m_predicted.attitude = {
+      rad(base_roll + wrap_pi(roll - base_roll)),
+      rad(pitch),
+      rad(base_yaw + wrap_pi(yaw - base_yaw))
+   };
+
+   // velocity and position
+   float v[3] = {
+      m_base.velocity_ned.x.numeric_value(),
+      m_base.velocity_ned.y.numeric_value(),
+      m_base.velocity_ned.z.numeric_value()
+   };
+   float d[3];
+   for ( int i = 0; i < 3; ++i){
+      d[i] = (v[i] + 0.5f * m_accel_ned[i] * t) * t;
+      v[i] += m_accel_ned[i] * t;
+   }
+   m_predicted.velocity_ned = {fdm_state::m_per_s{v[0]},fdm_state::m_per_s{v[1]},fdm_state::m_per_s{v[2]}};
+   m_predicted.climb_rate = fdm_state::m_per_s{-v[2]};
+   m_predicted.latitude = fdm_state::rad<double>{m_base.latitude.numeric_value() + d[0] * m_rad_per_m_north};
+   m_predicted.longitude = fdm_state::rad<double>{m_base.longitude.numeric_value() + d[1] * m_rad_per_m_east};
+   m_predicted.altitude = quan::length_<double>::m{m_base.altitude.numeric_value() - d[2]};
+   m_predicted.agl = fdm_state::m{m_base.agl.numeric_value() - d[2]};
+
+   // body velocity, advanced in the NED frame then rotated to the predicted body frame
+   for ( int i = 0; i < 3; ++i){
+      v[i] = m_velocity_body_ned[i] + m_accel_ned[i] * t;
+   }
+   float r[3][3];
+   rotation_from_quat(q,r);
+   m_predicted.velocity_body = {
+      fdm_state::m_per_s{r[0][0] * v[0] + r[1][0] * v[1] + r[2][0] * v[2]},
+      fdm_state::m_per_s{r[0][1] * v[0] + r[1][1] * v[1] + r[2][1] * v[2]},
+      fdm_state::m_per_s{r[0][2] * v[0] + r[1][2] * v[1] + r[2][2] * v[2]}
+   };
+   return m_predicted;
+}
@@ -0,0 +1,61 @@
+
+#include <cstddef>
+#include <byte_order.hpp>
+#include <fdm_state.hpp>
+
+namespace {
+
+   static_assert(sizeof(autoconv_FGNetFDM) == sizeof(FGNetFDM),"");
+
+   /// @brief layout of FGNetFDM : 2 x uint32_t , 3 x double , then only 4 byte values
+   constexpr size_t doubles_offset = offsetof(FGNetFDM,longitude);
+   constexpr size_t num_doubles = 3;
+   constexpr size_t words_offset = offsetof(FGNetFDM,agl);
+   constexpr size_t num_words = (sizeof(FGNetFDM) - words_offset) / 4;
+
+   static_assert(doubles_offset == 8,"");
+   static_assert(words_offset == doubles_offset + num_doubles * 8,"");
+   static_assert( (sizeof(FGNetFDM) - words_offset) % 4 == 0,"");
+
+   constexpr float m_per_ft = 0.3048f;
+   constexpr float m_per_s_per_knot = 1852.f / 3600.f;
+
+   fdm_state::rad<> rad(float v) { return fdm_state::rad<>{v};}
+
+   fdm_state::rad_per_s<> rad_per_s(float v) { return fdm_state::rad_per_s<>{fdm_state::rad<>{v}};}
+
+   fdm_state::m_per_s ft_per_s(float v) { return fdm_state::m_per_s{v * m_per_ft};}
+
+   fdm_state::m_per_s2 ft_per_s2(float v) { return fdm_state::m_per_s2{v * m_per_ft};}
+}
+
+void decode_fdm(autoconv_FGNetFDM const & in, fdm_state & out)
+{
+   auto const* src = reinterpret_cast<uint8_t const*>(&in);
+   auto* dst = reinterpret_cast<uint8_t*>(&out.raw);
+
+   ntoh32_n(dst, src, 2);
+   ntoh64_n(dst + doubles_offset, src + doubles_offset, num_doubles);
+   ntoh32_n(dst + words_offset, src + words_offset, num_words);
+
+   FGNetFDM const & r = out.raw;
+
+   out.longitude = fdm_state::rad<double>{r.longitude};
+   out.latitude = fdm_state::rad<double>{r.latitude};
+   out.altitude = quan::length_<double>::m{r.altitude};
+   out.agl = fdm_state::m{r.agl};
+
+   out.attitude = {rad(r.phi),rad(r.theta),rad(r.psi)};
+   out.alpha = rad(r.alpha);
+   out.beta = rad(r.beta);
+
+   out.attitude_rate = {rad_per_s(r.phidot),rad_per_s(r.thetadot),rad_per_s(r.psidot)};
+
+   out.vcas = fdm_state::m_per_s{r.vcas * m_per_s_per_knot};
+   out.climb_rate = ft_per_s(r.climb_rate);
+   out.velocity_ned = {ft_per_s(r.v_north),ft_per_s(r.v_east),ft_per_s(r.v_down)};
+   out.velocity_body = {ft_per_s(r.v_body_u),ft_per_s(r.v_body_v),ft_per_s(r.v_body_w)};
+   out.accel_body = {ft_per_s2(r.A_X_pilot),ft_per_s2(r.A_Y_pilot),ft_per_s2(r.A_Z_pilot)};
+
+   out.cur_time = r.cur_time;
+}
@@ -0,0 +1,161 @@
+
+#include <stdio.h>
+#include <errno.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <cstring>
+#include <new>
+#include <sys/socket.h>
+
+#include <fgfs_ctrls_out.hpp>
+
+namespace {
+
+   static_assert(sizeof(autoconv_FGNetCtrls) == sizeof(FGNetCtrls),"");
+
+   /**
+    * @brief FlightGear applies all the fields, so they must be set to something
+    * that keeps the aircraft flying and leaves the sim running
+    **/
+   void set_default_ctrls(autoconv_FGNetCtrls & ctrls)
+   {
+      ctrls.flaps_power = 1;
+      ctrls.flap_motor_ok = 1;
+
+      ctrls.num_engines = 1;
+      for ( uint32_t i = 0; i < autoconv_FGNetCtrls::max_engines; ++i){
+         ctrls.master_bat[i] = 1;
+         ctrls.master_alt[i] = 1;
+         ctrls.magnetos[i] = 3;  // both
+         ctrls.starter_power[i] = 0;
+         ctrls.throttle[i] = 0.0;
+         ctrls.mixture[i] = 1.0;
+         ctrls.condition[i] = 1.0;
+         ctrls.fuel_pump_power[i] = 1;
+         ctrls.prop_advance[i] = 1.0;
+         ctrls.engine_ok[i] = 1;
+         ctrls.mag_left_ok[i] = 1;
+         ctrls.mag_right_ok[i] = 1;
+         ctrls.spark_plugs_ok[i] = 1;
+         ctrls.oil_press_status[i] = 0;
+         ctrls.fuel_pump_ok[i] = 1;
+      }
+
+      ctrls.num_tanks = 1;
+      for ( uint32_t i = 0; i < autoconv_FGNetCtrls::max_tanks; ++i){
+         ctrls.fuel_selector[i] = 1;
+      }
+
+      ctrls.gear_handle = 1; // down
+      ctrls.master_avionics = 1;
+
+      ctrls.wind_speed_kt = quan::velocity_<double>::knot{0.0};
+      ctrls.wind_dir_deg = quan::angle_<double>::deg{0.0};
+      ctrls.turbulence_norm = 0.0;
+      ctrls.temp_c = quan::temperature_<double>::C{15.0};
+      ctrls.press_inhg = quan::pressure_<double>::inHg{29.92};
+
+      ctrls.speedup = 1;
+      ctrls.freeze = 0;
+   }
+}
+
+fgfs_ctrls_out::fgfs_ctrls_out(const char* hostname, int32_t port)
+: m_socket_fd{::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0)},
+  m_address{},
+  m_num_sent{0},
+  m_num_dropped{0}
+{
+   // start from all zeros, including the reserved fields, then reconstruct to set the version
+   ::memset(static_cast<void*>(&m_ctrls), 0, sizeof(m_ctrls));
+   ::new (&m_ctrls) autoconv_FGNetCtrls{};
+   set_default_ctrls(m_ctrls);
+
+   if (m_socket_fd == -1){
+      throw("fgfs_ctrls_out/socket");
+   }
+
+   struct hostent* hostinfo = gethostbyname(hostname);
+   if (!hostinfo) {
+      close();
+      throw("fgfs_ctrls_out/gethostbyname: unknown host");
+   }
+
+   m_address.sin_family = AF_INET;
+   m_address.sin_port = htons(port);
+   m_address.sin_addr = *(struct in_addr *)hostinfo->h_addr;
+
+   // connect so that each frame is a plain send, without an address lookup
+   if ( ::connect(m_socket_fd, (struct sockaddr *) &m_address, sizeof(m_address)) == -1){
+      close();
+      throw("fgfs_ctrls_out/connect");
+   }
+   ::fprintf(stdout,"ctrls out socket created\n");
+}
+
+fgfs_ctrls_out::~fgfs_ctrls_out()
+{
+   close();
+}
+
+void fgfs_ctrls_out::close()
+{
+   if ( m_socket_fd != -1){
+      ::close(m_socket_fd);
+      m_socket_fd = -1;
+   }
+}
+
+bool fgfs_ctrls_out::set_control(FlightDimension d, float_type const & value)
+{
+   switch(d){
+      case FlightDimension::Roll:
+         m_ctrls.aileron = static_cast<double>(value);
+         return true;
+      case FlightDimension::Pitch:
+         m_ctrls.elevator = static_cast<double>(value);
+         return true;
+      case FlightDimension::Yaw:
+         m_ctrls.rudder = static_cast<double>(value);
+         return true;
+      case FlightDimension::Throttle:
+         m_ctrls.throttle[0] = static_cast<double>(value);
+         return true;
+      case FlightDimension::Flap:
+         m_ctrls.flaps = static_cast<double>(value);
+         return true;
+      case FlightDimension::Spoiler:
+         m_ctrls.spoilers = static_cast<double>(value);
+         return true;
+      default:
+         return false;
+   }
+}
+
+bool fgfs_ctrls_out::end_frame()
+{
+   ssize_t const n = ::send(m_socket_fd, &m_ctrls, sizeof(m_ctrls), MSG_DONTWAIT);
+   if ( n == sizeof(m_ctrls)){
+      ++m_num_sent;
+      return true;
+   }
+   if ( n < 0){
+      switch(errno){
+         // ECONNREFUSED is a previous datagram bouncing because FlightGear isnt listening yet
+         case ECONNREFUSED:
+         case EAGAIN:
+#if EWOULDBLOCK != EAGAIN
+         case EWOULDBLOCK:
+#endif
+         case ENOBUFS:
+         case EINTR:
+            ++m_num_dropped;
+            return true;
+         default:
+            ::perror("fgfs_ctrls_out::end_frame send");
+            return false;
+      }
+   }
+   ::fprintf(stderr,"fgfs_ctrls_out::end_frame : short send\n");
+   return false;
+}
@@ -3,13 +3,17 @@
 #include <errno.h>
 #include <unistd.h>
 #include <netdb.h>
+#include <cstring>
 
 #include <fgfs_fdm_in.hpp>
 
 fgfs_fdm_in::fgfs_fdm_in(const char* hostname, int32_t port)
 :fdm{},
  m_socket_fd{::socket(AF_INET, SOCK_DGRAM, 0)}, // 
- m_address{}
+ m_address{},
+ m_num_skipped{0},
+ m_last_skipped{0},
+ m_arrival_time{0,0}
 {
    if (m_socket_fd == -1){
       ::perror("open socket failed");
@@ -26,6 +30,12 @@ fgfs_fdm_in::fgfs_fdm_in(const char* hostname, int32_t port)
    m_address.sin_port = htons(port);
    m_address.sin_addr = *(struct in_addr *)hostinfo->h_addr;
 
+   // ask the kernel to timestamp each packet on arrival, for latency measurement
+   int const enable = 1;
+   if ( ::setsockopt(m_socket_fd, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) < 0){
+      ::perror("fgfs_fdm_in : SO_TIMESTAMPNS not available");
+   }
+
    if (bind(m_socket_fd, (struct sockaddr *) &m_address,sizeof(m_address)) == -1){
       close();
       ::perror("bind");
@@ -64,12 +74,23 @@ bool fgfs_fdm_in::poll(quan::time::s const & time_to_wait)const
    }
 }
 
+void fgfs_fdm_in::set_receive_timeout(quan::time::ms const & t)
+{
+   int64_t const us = static_cast<int64_t>(t.numeric_value() * 1000);
+   struct timeval tv;
+   tv.tv_sec = us / 1000000;
+   tv.tv_usec = us % 1000000;
+   if ( ::setsockopt(m_socket_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0){
+      throw("fgfs_fdm_in/set_receive_timeout");
+   }
+}
+
 bool fgfs_fdm_in::update()
 {
    socklen_t address_size = sizeof(m_address);
 
-   // blocking read
-   ssize_t const nbytes_read = ::recvfrom(m_socket_fd,&fdm, sizeof(fdm),0,(struct sockaddr*)&m_address, &address_size );
+   // blocking read. MSG_TRUNC returns the real datagram length, so an oversized one isnt taken as an fdm
+   ssize_t const nbytes_read = ::recvfrom(m_socket_fd,&fdm, sizeof(fdm),MSG_TRUNC,(struct sockaddr*)&m_address, &address_size );
    if( nbytes_read == sizeof(fdm) ){
        return true;
    }else{
@@ -81,13 +102,105 @@ bool fgfs_fdm_in::update()
             ::fprintf(stderr,"recvfrom socket no bytes read\n");
             
          }else{
-            ::fprintf(stderr,"unknown error\n");
+            ::fprintf(stderr,"fgfs_fdm_in::update : bad packet size %zd\n",nbytes_read);
+            return false;
          }
       }
    }
    exit(errno);
 }
 
+namespace {
+
+   /**
+    * @brief get the kernel arrival time of the packet from SO_TIMESTAMPNS control message
+    * @return false if there was no timestamp
+    **/
+   bool get_kernel_timestamp(msghdr & msg, timespec & ts)
+   {
+      for ( cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg,cmsg)){
+         if ( (cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SCM_TIMESTAMPNS) ){
+            ::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+            return true;
+         }
+      }
+      return false;
+   }
+}
+
+/**
+ * recvmmsg with MSG_WAITFORONE blocks for the first datagram then returns whatever else is queued
+ * If a full batch was read there may be more queued, so go round again without blocking
+**/
+bool fgfs_fdm_in::update_latest()
+{
+   mmsghdr msgs[max_batch];
+   iovec iovecs[max_batch];
+   alignas(cmsghdr) char control[max_batch][CMSG_SPACE(sizeof(timespec))];
+   ::memset(msgs, 0, sizeof(msgs));
+   for ( uint32_t i = 0; i < max_batch; ++i){
+      iovecs[i].iov_base = &m_batch[i];
+      iovecs[i].iov_len = sizeof(m_batch[i]);
+      msgs[i].msg_hdr.msg_iov = &iovecs[i];
+      msgs[i].msg_hdr.msg_iovlen = 1;
+      msgs[i].msg_hdr.msg_control = control[i];
+      msgs[i].msg_hdr.msg_controllen = sizeof(control[i]);
+   }
+
+   uint32_t num_received = 0;
+   // MSG_TRUNC so msg_len is the real datagram length, and an oversized datagram is rejected not truncated
+   int flags = MSG_WAITFORONE | MSG_TRUNC;
+   autoconv_FGNetFDM const * latest = nullptr;
+   timespec latest_arrival_time = {0,0};
+   for (;;){
+      int const n = ::recvmmsg(m_socket_fd, msgs, max_batch, flags, nullptr);
+      if ( n < 0){
+         if ( (errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR) ){
+            break;
+         }
+         ::perror("error in recvmmsg\n");
+         exit(errno);
+      }
+      for ( int i = 0; i < n; ++i){
+         ++num_received;
+         if ( msgs[i].msg_len == sizeof(autoconv_FGNetFDM)){
+            latest = &m_batch[i];
+            if ( !get_kernel_timestamp(msgs[i].msg_hdr,latest_arrival_time)){
+               ::clock_gettime(CLOCK_REALTIME,&latest_arrival_time);
+            }
+         }else{
+            ::fprintf(stderr,"fgfs_fdm_in::update_latest : bad packet size %u\n",msgs[i].msg_len);
+         }
+      }
+      if ( static_cast<uint32_t>(n) < max_batch ){
+         break;
+      }
+      // a full batch, so more may be queued. Keep the newest so far in case the next read is empty
+      if ( latest != nullptr){
+         fdm = *latest;
+         latest = &fdm;
+      }
+      flags = MSG_DONTWAIT | MSG_TRUNC;
+      // recvmmsg updates msg_controllen, so reset for the next batch
+      for ( uint32_t i = 0; i < max_batch; ++i){
+         msgs[i].msg_hdr.msg_controllen = sizeof(control[i]);
+      }
+   }
+
+   if ( latest == nullptr){
+      m_last_skipped = num_received;
+      m_num_skipped += m_last_skipped;
+      return false;
+   }
+   if ( latest != &fdm){
+      fdm = *latest;
+   }
+   m_arrival_time = latest_arrival_time;
+   m_last_skipped = num_received - 1;
+   m_num_skipped += m_last_skipped;
+   return true;
+}
+
 void fgfs_fdm_in::close()
 {
    ::close(m_socket_fd);
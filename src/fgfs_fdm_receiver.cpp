@@ -0,0 +1,87 @@
+
+#include <climits>
+#include <cerrno>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#include <fgfs_fdm_receiver.hpp>
+
+namespace {
+
+   QUAN_QUANTITY_LITERAL(time,ms)
+
+   /// @brief how often the receive thread checks if it should stop
+   auto constexpr stop_check_period = 100_ms;
+
+   int futex(std::atomic<uint32_t> & word, int op, uint32_t val, timespec const * timeout)
+   {
+      static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),"");
+      return ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), op, val, timeout, nullptr, 0);
+   }
+}
+
+fgfs_fdm_receiver::fgfs_fdm_receiver(const char* hostname, int32_t port)
+: m_fdm_in{hostname,port},
+  m_fdm{},
+  m_frame_count{0},
+  m_num_waiters{0},
+  m_num_skipped{0},
+  m_running{false}
+{
+   m_fdm_in.set_receive_timeout(stop_check_period);
+}
+
+fgfs_fdm_receiver::~fgfs_fdm_receiver()
+{
+   stop();
+}
+
+void fgfs_fdm_receiver::start()
+{
+   if ( !m_running.exchange(true)){
+      m_thread = std::thread{[this]{ run();}};
+   }
+}
+
+void fgfs_fdm_receiver::stop()
+{
+   m_running = false;
+   if ( m_thread.joinable()){
+      m_thread.join();
+   }
+}
+
+void fgfs_fdm_receiver::run()
+{
+   while ( m_running.load(std::memory_order_relaxed)){
+      if ( m_fdm_in.update_latest()){
+         m_fdm.store(frame{m_fdm_in.get_fdm(),m_fdm_in.get_arrival_time()});
+         m_num_skipped.store(m_fdm_in.get_num_skipped(),std::memory_order_relaxed);
+         m_frame_count.fetch_add(1,std::memory_order_release);
+         // only pay for the wakeup syscall if someone is waiting
+         if ( m_num_waiters.load(std::memory_order_seq_cst) > 0){
+            futex(m_frame_count,FUTEX_WAKE_PRIVATE,INT_MAX,nullptr);
+         }
+      }
+   }
+}
+
+bool fgfs_fdm_receiver::wait_for_frame(uint32_t last_frame, quan::time::ms const & timeout) const
+{
+   int64_t const ns = static_cast<int64_t>(timeout.numeric_value() * 1000000);
+   timespec ts;
+   ts.tv_sec = ns / 1000000000;
+   ts.tv_nsec = ns % 1000000000;
+
+   m_num_waiters.fetch_add(1,std::memory_order_seq_cst);
+   // read the futex word before checking, so a frame published in between changes the word and the wait returns
+   uint32_t const word = m_frame_count.load(std::memory_order_seq_cst);
+   bool result = m_fdm.get_count() != last_frame;
+   if ( !result){
+      futex(m_frame_count,FUTEX_WAIT_PRIVATE,word,&ts);
+      result = m_fdm.get_count() != last_frame;
+   }
+   m_num_waiters.fetch_sub(1,std::memory_order_relaxed);
+   return result;
+}
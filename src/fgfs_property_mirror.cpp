@@ -0,0 +1,97 @@
+
+#include <cstdio>
+#include <cstring>
+#include <fgfs_property_mirror.hpp>
+
+bool fgfs_property_mirror::normalise_path(const char* path, char* dest, uint32_t dest_len)
+{
+   uint32_t n = 0;
+   while ( *path != '\0'){
+      if ( ::strncmp(path,"[0]",3) == 0){
+         path += 3;
+         continue;
+      }
+      if ( n + 1 >= dest_len){
+         return false;
+      }
+      dest[n++] = *path++;
+   }
+   dest[n] = '\0';
+   return true;
+}
+
+bool fgfs_property_mirror::add_path(const char* path)
+{
+   uint32_t const idx = m_batch.size();
+   if ( m_subscribed || (idx == max_properties) ){
+      return false;
+   }
+   return normalise_path(path,m_paths[idx],max_path_len);
+}
+
+bool fgfs_property_mirror::subscribe()
+{
+   if ( m_subscribed){
+      return true;
+   }
+   bool const result = m_telnet.get(m_batch);
+
+   // send all the subscribe commands in one write
+   size_t len = 0;
+   for ( uint32_t i = 0; i < m_batch.size(); ++i){
+      len += ::strlen(m_batch.get_prop(i)) + 12; // "subscribe " + prop + "\r\n"
+   }
+   char buf[len + 1];
+   char* p = buf;
+   for ( uint32_t i = 0; i < m_batch.size(); ++i){
+      p += ::sprintf(p,"subscribe %s\015\012",m_batch.get_prop(i));
+   }
+   if ( !m_telnet.write_all(buf, p - buf)){
+      return false;
+   }
+   m_subscribed = true;
+   return result;
+}
+
+bool fgfs_property_mirror::process_input()
+{
+   for(;;){
+      const char* line = nullptr;
+      if ( !m_telnet.read_line_nonblocking(line)){
+         return false;
+      }
+      if ( line == nullptr){
+         return true;
+      }
+      if ( process_line(line)){
+         ++m_num_updates;
+      }else{
+         ++m_num_unknown;
+      }
+   }
+}
+
+bool fgfs_property_mirror::process_line(const char* line)
+{
+   const char* const eq = ::strchr(line,'=');
+   if ( eq == nullptr){
+      return false;
+   }
+   char path[max_path_len];
+   uint32_t const path_len = eq - line;
+   if ( path_len >= max_path_len){
+      return false;
+   }
+   ::memcpy(path,line,path_len);
+   path[path_len] = '\0';
+   char normalised_path[max_path_len];
+   if ( !normalise_path(path,normalised_path,max_path_len)){
+      return false;
+   }
+   for ( uint32_t i = 0; i < m_batch.size(); ++i){
+      if ( ::strcmp(normalised_path,m_paths[i]) == 0){
+         return m_batch.set_value(i, eq + 1);
+      }
+   }
+   return false;
+}
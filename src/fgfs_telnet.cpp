@@ -1,14 +1,17 @@
 
 #include <cstdarg>
 #include <cstdio>
+#include <cstdlib>
 #include <cerrno>
 #include <cstring>
 #include <unistd.h>
 
 #include <netdb.h>
+#include <sys/socket.h>
 #include <netinet/in.h>
 
 #include <fgfs_telnet.hpp>
+#include <format_fixed.hpp>
 
 /*
  Copyright (C) Andy Little 2021
@@ -30,19 +33,6 @@ namespace {
    {
       return f.write("set %s %f",prop,static_cast<double>(val));
    }
-
-   static bool get(fgfs_telnet & f, const char* prop, T & val)
-   {
-      f.write("get %s",prop);
-      const char* p = f.read();
-      if (p){
-         double const v = atof(p);
-         val = static_cast<T>(v);
-         return true;
-      }else{
-         return false;
-      }
-   }
    };
 
    template <typename T>
@@ -53,26 +43,55 @@ namespace {
          int32_t v = static_cast<int32_t>(val);
          return f.write("set %s %d",prop,v);
       }
+   };
 
-      static bool get(fgfs_telnet & f, const char* prop, T & val)
-      {
-         f.write("get %s",prop);
-         const char* p = f.read();
-         if (p){
-            int32_t const v = atoi(p);
-            val = static_cast<T>(v);
+   /**
+    * @brief parse a get reply into its destination
+    * @return false if the reply was an error ( e.g "-ERR Node not found") or not a number
+    **/
+   bool parse_reply(const char* reply, void* dest, fgfs_telnet_get_batch::dest_type type)
+   {
+      if ( (reply == nullptr) || (*reply == '\0') || (*reply == '-' && reply[1] == 'E') ){
+         return false;
+      }
+      char* end = nullptr;
+      switch (type){
+         case fgfs_telnet_get_batch::dest_type::Double:{
+            double const v = ::strtod(reply,&end);
+            if ( end == reply){
+               return false;
+            }
+            *static_cast<double*>(dest) = v;
+            return true;
+         }
+         case fgfs_telnet_get_batch::dest_type::Float:{
+            double const v = ::strtod(reply,&end);
+            if ( end == reply){
+               return false;
+            }
+            *static_cast<float*>(dest) = static_cast<float>(v);
+            return true;
+         }
+         case fgfs_telnet_get_batch::dest_type::Int32:{
+            long const v = ::strtol(reply,&end,10);
+            if ( end == reply){
+               return false;
+            }
+            *static_cast<int32_t*>(dest) = static_cast<int32_t>(v);
             return true;
-         }else{
-            return false;
          }
+         default:
+            return false;
       }
-   };
+   }
 }
 
 fgfs_telnet::fgfs_telnet(const char *hostname, unsigned port,size_t buflen) :
 	m_sock{::socket(PF_INET, SOCK_STREAM, IPPROTO_TCP)},
    m_buffer{new char [buflen]{'0'}},
    m_buflen{buflen},
+   m_line_start{0},
+   m_buffer_used{0},
 	m_timeout{5_s},
 	m_connected{false}
 {
@@ -168,6 +187,39 @@ bool fgfs_telnet::write(const char *msg, ...)const
 	return len_written == len_to_write;
 }
 
+bool fgfs_telnet::set(fgfs_prop prop, double val) const
+{
+   char buf[128];
+   size_t const prefix_len = get_set_prefix_len(prop);
+   ::memcpy(buf, get_set_prefix(prop), prefix_len);
+   char* p = format_fixed(buf + prefix_len, buf + sizeof(buf) - 2, val);
+   if ( p == nullptr){
+      return false;
+   }
+   *p++ = '\015';
+   *p++ = '\012';
+   return write_all(buf, p - buf);
+}
+
+bool fgfs_telnet::write_all(const char* buf, size_t len) const
+{
+   while ( len > 0){
+      if ( !is_writeable(m_timeout)){
+         throw ("fgfs_telnet::write_all - not writeable");
+      }
+      ::ssize_t const len_written = ::write(m_sock, buf, len);
+      if (len_written < 0){
+         if ( errno == EINTR){
+            continue;
+         }
+         throw("fgfs_telnet::write_all");
+      }
+      buf += len_written;
+      len -= len_written;
+   }
+   return true;
+}
+
 bool fgfs_telnet::is_readable(quan::time::s const & time_to_wait) const
 {
    fd_set fd;
@@ -184,22 +236,81 @@ bool fgfs_telnet::is_readable(quan::time::s const & time_to_wait) const
 
 const char * fgfs_telnet::read()
 {
-   if ( !is_readable(m_timeout)){
-      throw ("fgfs_telnet::read - not readable");
+   const char* const line = read_line();
+	return ( (line != nullptr) && (*line != '\0') ) ? line : nullptr;
+}
+
+char * fgfs_telnet::take_buffered_line()
+{
+   char* const begin = m_buffer + m_line_start;
+   char* const end = m_buffer + m_buffer_used;
+   char* const eol = static_cast<char*>(::memchr(begin,'\012',end - begin));
+   if ( eol == nullptr){
+      // no complete line yet, so move the partial line to the front to make room for more
+      if ( m_line_start > 0){
+         ::memmove(m_buffer, begin, end - begin);
+         m_buffer_used -= m_line_start;
+         m_line_start = 0;
+      }
+      if ( m_buffer_used >= m_buflen - 1){
+         throw("fgfs_telnet - line too long for buffer");
+      }
+      return nullptr;
    }
-   
-	ssize_t len = ::read(m_sock, m_buffer, m_buflen - 1);
-	if (len < 0)
-		throw("fgfs_telnet::read/read");
-	if (len == 0)
-		return 0;
+   m_line_start = (eol + 1) - m_buffer;
+   char* p = eol;
+   while ( (p > begin) && (p[-1] == '\015') ){
+      --p;
+   }
+   *p = '\0';
+   return begin;
+}
 
-   char *p;
-	for (p = &m_buffer[len - 1]; p >= m_buffer; p--)
-		if (*p != '\015' && *p != '\012')
-			break;
-	*++p = '\0';
-	return strlen(m_buffer) ? m_buffer : nullptr;
+const char * fgfs_telnet::read_line()
+{
+   for(;;){
+      if ( const char* const line = take_buffered_line()){
+         return line;
+      }
+      if ( !is_readable(m_timeout)){
+         throw ("fgfs_telnet::read_line - not readable");
+      }
+      ssize_t const len = ::read(m_sock, m_buffer + m_buffer_used, m_buflen - 1 - m_buffer_used);
+      if (len < 0){
+         if ( errno == EINTR){
+            continue;
+         }
+         throw("fgfs_telnet::read_line/read");
+      }
+      if (len == 0){
+         return nullptr;
+      }
+      m_buffer_used += len;
+   }
+}
+
+bool fgfs_telnet::read_line_nonblocking(const char* & line)
+{
+   for(;;){
+      line = take_buffered_line();
+      if ( line != nullptr){
+         return true;
+      }
+      ssize_t const len = ::recv(m_sock, m_buffer + m_buffer_used, m_buflen - 1 - m_buffer_used, MSG_DONTWAIT);
+      if ( len > 0){
+         m_buffer_used += len;
+         continue;
+      }
+      if ( len == 0){
+         return false;
+      }
+      if ( (errno == EAGAIN) || (errno == EWOULDBLOCK) ){
+         return true;
+      }
+      if ( errno != EINTR){
+         throw("fgfs_telnet::read_line_nonblocking");
+      }
+   }
 }
 
 inline void fgfs_telnet::flush(void)
@@ -209,14 +320,77 @@ inline void fgfs_telnet::flush(void)
         read();
       }
    }catch(...){
-      return;
    }
+   m_line_start = 0;
+   m_buffer_used = 0;
+}
+
+bool fgfs_telnet::drain_input()
+{
+   m_line_start = 0;
+   m_buffer_used = 0;
+   for(;;){
+      ssize_t const len = ::recv(m_sock, m_buffer, m_buflen, MSG_DONTWAIT);
+      if ( len > 0){
+         continue;
+      }
+      if ( len == 0){
+         return false;
+      }
+      if ( (errno == EAGAIN) || (errno == EWOULDBLOCK) ){
+         return true;
+      }
+      if ( errno != EINTR){
+         throw("fgfs_telnet::drain_input");
+      }
+   }
+}
+
+/**
+ * FlightGear replies to every get in data mode with exactly one line, 
+ * either the value or an error, so the replies can be matched to the gets in order
+**/
+bool fgfs_telnet::get(fgfs_telnet_get_batch const & batch)
+{
+   if ( batch.m_size == 0){
+      return true;
+   }
+   size_t len = 0;
+   for ( uint32_t i = 0; i < batch.m_size; ++i){
+      len += ::strlen(batch.m_entries[i].prop) + 6; // "get " + prop + "\r\n"
+   }
+   char buf[len + 1];
+   char* p = buf;
+   for ( uint32_t i = 0; i < batch.m_size; ++i){
+      p += ::sprintf(p,"get %s\015\012",batch.m_entries[i].prop);
+   }
+   write_all(buf, p - buf);
+
+   bool result = true;
+   for ( uint32_t i = 0; i < batch.m_size; ++i){
+      auto const & entry = batch.m_entries[i];
+      const char* const reply = read_line();
+      if ( reply == nullptr){
+         return false;
+      }
+      if ( !parse_reply(reply,entry.dest,entry.type)){
+         result = false;
+      }
+   }
+   return result;
+}
+
+bool fgfs_telnet_get_batch::set_value(uint32_t i, const char* text) const
+{
+   return (i < m_size) && parse_reply(text,m_entries[i].dest,m_entries[i].type);
 }
 
 template <typename T>
 bool fgfs_telnet::get(const char* prop, T& val)
 {
-   return ll_telnet<T>::get(*this,prop,val);
+   fgfs_telnet_get_batch batch;
+   batch.add(prop,val);
+   return get(batch);
 }
 
 template <typename T>
@@ -0,0 +1,79 @@
+
+#include <cerrno>
+#include <fixed_rate_scheduler.hpp>
+
+fixed_rate_scheduler::fixed_rate_scheduler(const char* name, quan::time::us const & period)
+: m_name{name},
+  m_period_ns{static_cast<int64_t>(period.numeric_value() * 1000)},
+  m_next_deadline_ns{0},
+  m_num_overruns{0},
+  m_num_missed_periods{0},
+  m_jitter{"jitter"},
+  m_overrun{"overrun"}
+{
+   if ( m_period_ns <= 0){
+      throw("fixed_rate_scheduler/bad period");
+   }
+   start();
+}
+
+void fixed_rate_scheduler::start()
+{
+   m_next_deadline_ns = get_time_ns(CLOCK_MONOTONIC) + m_period_ns;
+}
+
+timespec fixed_rate_scheduler::get_next_deadline() const
+{
+   timespec ts;
+   ts.tv_sec = m_next_deadline_ns / 1000000000;
+   ts.tv_nsec = m_next_deadline_ns % 1000000000;
+   return ts;
+}
+
+uint64_t fixed_rate_scheduler::wait()
+{
+   int64_t const now = get_time_ns(CLOCK_MONOTONIC);
+   if ( now >= m_next_deadline_ns){
+      // overran. run now and skip any whole periods missed
+      m_overrun.record(now - m_next_deadline_ns);
+      ++m_num_overruns;
+      uint64_t const missed = static_cast<uint64_t>((now - m_next_deadline_ns) / m_period_ns);
+      m_num_missed_periods += missed;
+      m_next_deadline_ns += static_cast<int64_t>(missed + 1) * m_period_ns;
+      return missed + 1;
+   }
+   timespec const deadline = get_next_deadline();
+   while ( ::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR){;}
+   m_jitter.record(get_time_ns(CLOCK_MONOTONIC) - m_next_deadline_ns);
+   m_next_deadline_ns += m_period_ns;
+   return 1;
+}
+
+void fixed_rate_scheduler::on_expired(uint64_t expirations)
+{
+   if ( expirations == 0){
+      return;
+   }
+   int64_t const now = get_time_ns(CLOCK_MONOTONIC);
+   // the latest deadline that has expired
+   int64_t const deadline = m_next_deadline_ns + static_cast<int64_t>(expirations - 1) * m_period_ns;
+   m_jitter.record(now - deadline);
+   if ( expirations > 1){
+      ++m_num_overruns;
+      m_num_missed_periods += expirations - 1;
+      m_overrun.record(now - m_next_deadline_ns);
+   }
+   m_next_deadline_ns = deadline + m_period_ns;
+}
+
+void fixed_rate_scheduler::dump(FILE* f) const
+{
+   ::fprintf(f,"%s : period = %lld ns, overruns = %llu, missed periods = %llu\n",
+      m_name,
+      static_cast<long long>(m_period_ns),
+      static_cast<unsigned long long>(m_num_overruns),
+      static_cast<unsigned long long>(m_num_missed_periods)
+   );
+   m_jitter.dump(f);
+   m_overrun.dump(f);
+}
@@ -1,74 +1,140 @@
 
 
-
 #include <quan/config.hpp>
 
 // Linux impl
-#include <termios.h>
+#include <atomic>
+#include <csignal>
 #include <cstdio>
+#include <cerrno>
+#include <cstdlib>
+#include <termios.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <flight_mode.hpp>
 
-// from
-// http://stackoverflow.com/questions/22166074/is-there-a-way-to-detect-if-a-key-has-been-pressed
 namespace {
 
+   std::atomic<flight_mode> m_flight_mode{flight_mode::Manual};
+
+   termios original_termios;
+   bool have_original_termios = false;
+   int original_flags = 0;
+   bool keyboard_initialised = false;
+
    /**
-    * @brief get any input from keyboard
-    * @return keyboard char or EOF if no key pressed
+    * @brief put the terminal back as it was. Only async signal safe calls.
+    * Restores the file flags too, in case of a signal while stdin is non-blocking
    **/
-   int get_keyboard()
+   void restore_keyboard()
    {
-     termios oldt;
-     tcgetattr(STDIN_FILENO, &oldt);
-
-     termios newt = oldt;
-     newt.c_lflag &= ~(ICANON | ECHO);
-     tcsetattr(STDIN_FILENO, TCSANOW, &newt);
-
-     int oldf = fcntl(STDIN_FILENO, F_GETFL, 0);
-
-     fcntl(STDIN_FILENO, F_SETFL, oldf | O_NONBLOCK);
-
-     int ch = getchar();
+      if ( have_original_termios){
+         ::tcsetattr(STDIN_FILENO, TCSANOW, &original_termios);
+      }
+      if ( keyboard_initialised){
+         ::fcntl(STDIN_FILENO, F_SETFL, original_flags);
+      }
+   }
 
-     tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
-     fcntl(STDIN_FILENO, F_SETFL, oldf);
+   /**
+    * @brief stdin is non-blocking only for the lifetime of this object.
+    * O_NONBLOCK is on the open file description, which a terminal shares with stdout, stderr
+    * and child processes such as fgfs, so it mustn't be left on
+   **/
+   struct scoped_nonblocking_stdin{
+      scoped_nonblocking_stdin() : m_flags{::fcntl(STDIN_FILENO, F_GETFL, 0)}
+      {
+         if ( m_flags != -1){
+            ::fcntl(STDIN_FILENO, F_SETFL, m_flags | O_NONBLOCK);
+         }
+      }
+      ~scoped_nonblocking_stdin()
+      {
+         if ( m_flags != -1){
+            ::fcntl(STDIN_FILENO, F_SETFL, m_flags);
+         }
+      }
+      scoped_nonblocking_stdin(scoped_nonblocking_stdin const &) = delete;
+      scoped_nonblocking_stdin& operator =(scoped_nonblocking_stdin const &) = delete;
+   private:
+      int const m_flags;
+   };
+
+   void on_terminate_signal(int sig)
+   {
+      restore_keyboard();
+      ::signal(sig, SIG_DFL);
+      ::raise(sig);
+   }
 
-     return ch;
+   void on_key(int key)
+   {
+      auto const old_mode = m_flight_mode.load(std::memory_order_relaxed);
+      switch( key){
+        case 'a':
+          if ( old_mode != flight_mode:: StraightnLevel){
+            m_flight_mode.store(flight_mode:: StraightnLevel, std::memory_order_relaxed);
+            fprintf(stderr,"Flightmode changed to StraightnLevel\n");
+          }
+          break;
+        case ' ':
+           if ( old_mode != flight_mode:: Manual){
+              m_flight_mode.store(flight_mode:: Manual, std::memory_order_relaxed);
+              fprintf(stderr,"Flightmode changed to Manual\n");
+           }
+           break;
+        default:
+           fprintf(stderr,"unknown key press %d\n",key);
+          break;
+      }
    }
 }
 
-
-namespace {
-  flight_mode m_flight_mode = flight_mode::Manual;
+int init_keyboard()
+{
+   if ( !keyboard_initialised){
+      original_flags = ::fcntl(STDIN_FILENO, F_GETFL, 0);
+      keyboard_initialised = true;
+      ::atexit(restore_keyboard);
+      ::signal(SIGINT, on_terminate_signal);
+      ::signal(SIGTERM, on_terminate_signal);
+      // stdin may not be a terminal e.g redirected
+      if ( ::isatty(STDIN_FILENO) && (::tcgetattr(STDIN_FILENO, &original_termios) == 0) ){
+         have_original_termios = true;
+         termios raw = original_termios;
+         raw.c_lflag &= ~(ICANON | ECHO);
+         // VMIN 1 so that a non-blocking read with nothing pending fails with EAGAIN. With VMIN 0 it returns 0,
+         // which is indistinguishable from end of input
+         raw.c_cc[VMIN] = 1;
+         raw.c_cc[VTIME] = 0;
+         ::tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+      }
+   }
+   return STDIN_FILENO;
 }
 
-
-flight_mode get_flight_mode()
+bool process_keyboard_input()
 {
-   int key = get_keyboard();
-   auto old_mode = m_flight_mode;
-   switch( key){
-     case EOF:
-         break;
-     case 'a':
-       if ( old_mode != flight_mode:: StraightnLevel){
-         m_flight_mode = flight_mode:: StraightnLevel;
-         fprintf(stderr,"Flightmode changed to StraightnLevel\n");
-       }
-       break;
-     case ' ':
-        if ( old_mode != flight_mode:: Manual){
-           m_flight_mode = flight_mode:: Manual;
-           fprintf(stderr,"Flightmode changed to Manual\n");
-        }
-     default:
-        fprintf(stderr,"unknown key press %d\n",key);
-       break;
+   scoped_nonblocking_stdin const nonblocking;
+   char buf[32];
+   for(;;){
+      ssize_t const n = ::read(STDIN_FILENO, buf, sizeof(buf));
+      if ( n > 0){
+         for ( ssize_t i = 0; i < n; ++i){
+            on_key(static_cast<unsigned char>(buf[i]));
+         }
+      }else if ( n == 0){
+         // end of a redirected input. A terminal doesnt return 0 in raw mode, but if it does keep waiting on it
+         return ::isatty(STDIN_FILENO) != 0;
+      }else{
+         // EAGAIN when all read
+         return (errno != EBADF) && (errno != EIO);
+      }
    }
-   return m_flight_mode;
 }
 
+flight_mode get_flight_mode()
+{
+   return m_flight_mode.load(std::memory_order_relaxed);
+}
 
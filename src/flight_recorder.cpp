@@ -0,0 +1,227 @@
+
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <flight_recorder.hpp>
+
+namespace {
+
+   static_assert(sizeof(autoconv_FGNetFDM) == sizeof(FGNetFDM),"");
+
+   constexpr uint64_t page_size = 4096;
+
+   constexpr uint64_t round_up_to_page(uint64_t n)
+   {
+      return ((n + page_size - 1) / page_size) * page_size;
+   }
+
+   int64_t realtime_ns()
+   {
+      timespec ts;
+      ::clock_gettime(CLOCK_REALTIME,&ts);
+      return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+   }
+
+   /**
+    * @brief mark a slot as being written. A reader ( or a crash) in between sees seq 0 and skips it
+    **/
+   void begin_record(uint64_t & seq)
+   {
+      __atomic_store_n(&seq, 0, __ATOMIC_RELAXED);
+      __atomic_thread_fence(__ATOMIC_RELEASE);
+   }
+
+   /**
+    * @brief publish a completely written slot
+    **/
+   void end_record(uint64_t & seq, uint64_t value, uint64_t & header_next_seq)
+   {
+      __atomic_store_n(&seq, value, __ATOMIC_RELEASE);
+      __atomic_store_n(&header_next_seq, value + 1, __ATOMIC_RELEASE);
+   }
+
+   /**
+    * @brief find the range of sequence numbers present in a ring.
+    * Slot i only ever holds seq where (seq - 1) % capacity == i
+    **/
+   template <typename Record>
+   void find_seq_range(Record const * records, uint64_t capacity, uint64_t & first, uint64_t & last)
+   {
+      last = 0;
+      for ( uint64_t i = 0; i < capacity; ++i){
+         uint64_t const seq = __atomic_load_n(&records[i].seq, __ATOMIC_ACQUIRE);
+         if ( seq > last){
+            last = seq;
+         }
+      }
+      first = (last > capacity) ? (last - capacity + 1) : 1;
+   }
+
+   template <typename Record>
+   Record const * get_record(Record const * records, uint64_t capacity, uint64_t seq)
+   {
+      if ( (seq == 0) || (capacity == 0) ){
+         return nullptr;
+      }
+      Record const & r = records[(seq - 1) % capacity];
+      return (__atomic_load_n(&r.seq, __ATOMIC_ACQUIRE) == seq) ? &r : nullptr;
+   }
+}
+
+flight_recorder::flight_recorder(const char* path, uint64_t fdm_capacity, uint64_t control_capacity)
+: m_fd{::open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)},
+  m_map{nullptr},
+  m_map_size{0},
+  m_fdm_records{nullptr},
+  m_control_records{nullptr},
+  m_fdm_capacity{fdm_capacity},
+  m_control_capacity{control_capacity},
+  m_fdm_next_seq{1},
+  m_control_next_seq{1}
+{
+   if ( m_fd < 0){
+      throw("flight_recorder/open");
+   }
+   uint64_t const fdm_offset = round_up_to_page(sizeof(flight_log::file_header));
+   uint64_t const control_offset = round_up_to_page(fdm_offset + fdm_capacity * sizeof(flight_log::fdm_record));
+   m_map_size = round_up_to_page(control_offset + control_capacity * sizeof(flight_log::control_record));
+
+   // reserve the disk space now, so we dont get SIGBUS when the disk fills mid flight
+   if ( ::posix_fallocate(m_fd, 0, static_cast<off_t>(m_map_size)) != 0){
+      ::close(m_fd);
+      throw("flight_recorder/posix_fallocate");
+   }
+   // MAP_POPULATE prefaults the pages so the hot path doesnt take page faults
+   void* const map = ::mmap(nullptr, m_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, 0);
+   if ( map == MAP_FAILED){
+      ::close(m_fd);
+      throw("flight_recorder/mmap");
+   }
+   m_map = static_cast<uint8_t*>(map);
+   m_fdm_records = reinterpret_cast<flight_log::fdm_record*>(m_map + fdm_offset);
+   m_control_records = reinterpret_cast<flight_log::control_record*>(m_map + control_offset);
+
+   flight_log::file_header & h = header();
+   ::memcpy(h.magic, flight_log::magic, sizeof(h.magic));
+   h.version = flight_log::version;
+   h.header_size = sizeof(flight_log::file_header);
+   h.fdm_record_size = sizeof(flight_log::fdm_record);
+   h.control_record_size = sizeof(flight_log::control_record);
+   h.fdm_capacity = fdm_capacity;
+   h.control_capacity = control_capacity;
+   h.fdm_offset = fdm_offset;
+   h.control_offset = control_offset;
+   h.fdm_next_seq = 1;
+   h.control_next_seq = 1;
+}
+
+flight_recorder::~flight_recorder()
+{
+   if ( m_map != nullptr){
+      ::msync(m_map, m_map_size, MS_SYNC);
+      ::munmap(m_map, m_map_size);
+   }
+   ::close(m_fd);
+}
+
+void flight_recorder::record_fdm(autoconv_FGNetFDM const & fdm, timespec const & arrival_time)
+{
+   if ( m_fdm_capacity == 0){
+      return;
+   }
+   uint64_t const seq = m_fdm_next_seq++;
+   flight_log::fdm_record & r = m_fdm_records[(seq - 1) % m_fdm_capacity];
+   begin_record(r.seq);
+   r.time_ns = static_cast<int64_t>(arrival_time.tv_sec) * 1000000000 + arrival_time.tv_nsec;
+   ::memcpy(&r.fdm, &fdm, sizeof(r.fdm));
+   end_record(r.seq, seq, header().fdm_next_seq);
+}
+
+void flight_recorder::record_controls(float aileron, float elevator, float rudder, float throttle)
+{
+   if ( m_control_capacity == 0){
+      return;
+   }
+   uint64_t const seq = m_control_next_seq++;
+   flight_log::control_record & r = m_control_records[(seq - 1) % m_control_capacity];
+   begin_record(r.seq);
+   r.time_ns = realtime_ns();
+   r.aileron = aileron;
+   r.elevator = elevator;
+   r.rudder = rudder;
+   r.throttle = throttle;
+   end_record(r.seq, seq, header().control_next_seq);
+}
+
+void flight_recorder::sync()
+{
+   ::msync(m_map, m_map_size, MS_ASYNC);
+}
+
+flight_log_reader::flight_log_reader(const char* path)
+: m_map{nullptr},
+  m_map_size{0},
+  m_fdm_records{nullptr},
+  m_control_records{nullptr},
+  m_fdm_capacity{0},
+  m_control_capacity{0},
+  m_first_fdm_seq{1},
+  m_last_fdm_seq{0},
+  m_first_control_seq{1},
+  m_last_control_seq{0}
+{
+   int const fd = ::open(path, O_RDONLY | O_CLOEXEC);
+   if ( fd < 0){
+      throw("flight_log_reader/open");
+   }
+   struct stat st;
+   if ( (::fstat(fd,&st) < 0) || (static_cast<size_t>(st.st_size) < sizeof(flight_log::file_header)) ){
+      ::close(fd);
+      throw("flight_log_reader/bad file size");
+   }
+   m_map_size = static_cast<size_t>(st.st_size);
+   void* const map = ::mmap(nullptr, m_map_size, PROT_READ, MAP_SHARED, fd, 0);
+   ::close(fd);
+   if ( map == MAP_FAILED){
+      throw("flight_log_reader/mmap");
+   }
+   m_map = static_cast<uint8_t const*>(map);
+
+   auto const & h = *reinterpret_cast<flight_log::file_header const*>(m_map);
+   if ( (::memcmp(h.magic, flight_log::magic, sizeof(h.magic)) != 0) ||
+         (h.version != flight_log::version) ||
+         (h.fdm_record_size != sizeof(flight_log::fdm_record)) ||
+         (h.control_record_size != sizeof(flight_log::control_record)) ||
+         (h.fdm_offset + h.fdm_capacity * sizeof(flight_log::fdm_record) > m_map_size) ||
+         (h.control_offset + h.control_capacity * sizeof(flight_log::control_record) > m_map_size) ){
+      ::munmap(const_cast<uint8_t*>(m_map), m_map_size);
+      throw("flight_log_reader/not a flight log");
+   }
+   m_fdm_capacity = h.fdm_capacity;
+   m_control_capacity = h.control_capacity;
+   m_fdm_records = reinterpret_cast<flight_log::fdm_record const*>(m_map + h.fdm_offset);
+   m_control_records = reinterpret_cast<flight_log::control_record const*>(m_map + h.control_offset);
+
+   // dont trust the header next_seq after a crash, derive the ranges from the records
+   find_seq_range(m_fdm_records, m_fdm_capacity, m_first_fdm_seq, m_last_fdm_seq);
+   find_seq_range(m_control_records, m_control_capacity, m_first_control_seq, m_last_control_seq);
+}
+
+flight_log_reader::~flight_log_reader()
+{
+   ::munmap(const_cast<uint8_t*>(m_map), m_map_size);
+}
+
+flight_log::fdm_record const * flight_log_reader::get_fdm_record(uint64_t seq) const
+{
+   return get_record(m_fdm_records, m_fdm_capacity, seq);
+}
+
+flight_log::control_record const * flight_log_reader::get_control_record(uint64_t seq) const
+{
+   return get_record(m_control_records, m_control_capacity, seq);
+}
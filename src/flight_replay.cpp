@@ -0,0 +1,44 @@
+
+#include <cstring>
+#include <flight_replay.hpp>
+
+flight_replay_stats replay_flight_log(
+   flight_log_reader const & log,
+   abc_flight_controller & fc,
+   quan::time::ms const & default_time_step,
+   std::function<void(flight_log::fdm_record const &)> const & on_frame)
+{
+   flight_replay_stats stats;
+   int64_t const start = get_time_ns(CLOCK_MONOTONIC);
+   int64_t first_time_ns = 0;
+   int64_t prev_time_ns = 0;
+   autoconv_FGNetFDM fdm;
+   uint64_t const last_seq = log.get_last_fdm_seq();
+   for ( uint64_t seq = log.get_first_fdm_seq(); seq <= last_seq; ++seq){
+      flight_log::fdm_record const * const r = log.get_fdm_record(seq);
+      if ( r == nullptr){
+         ++stats.num_missing;
+         continue;
+      }
+      quan::time::ms time_step = default_time_step;
+      if ( stats.num_frames == 0){
+         first_time_ns = r->time_ns;
+      }else if ( r->time_ns > prev_time_ns){
+         time_step = quan::time::ms{(r->time_ns - prev_time_ns) / 1.e6};
+      }
+      prev_time_ns = r->time_ns;
+      if ( on_frame){
+         on_frame(*r);
+      }
+      ::memcpy(&fdm,&r->fdm,sizeof(fdm));
+      if ( !fc.update(fdm,time_step)){
+         stats.replay_time_ns = get_time_ns(CLOCK_MONOTONIC) - start;
+         return stats;
+      }
+      ++stats.num_frames;
+      stats.flight_time_ns = prev_time_ns - first_time_ns;
+   }
+   stats.replay_time_ns = get_time_ns(CLOCK_MONOTONIC) - start;
+   stats.completed = true;
+   return stats;
+}
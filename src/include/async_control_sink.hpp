@@ -0,0 +1,79 @@
+#ifndef FG_EXT_ASYNC_CONTROL_SINK_HPP_INCLUDED
+#define FG_EXT_ASYNC_CONTROL_SINK_HPP_INCLUDED
+
+#include <atomic>
+#include <thread>
+#include <control_sink.hpp>
+
+/**
+ * @brief hand control values to a sender thread, so that a slow sink
+ * ( e.g a congested FlightGear telnet server) can't stall the control loop.
+ * Each control has one slot holding its latest value plus a pending bit. set_control
+ * just stores the value and sets the bit, without locks or syscalls, other than waking the sender
+ * when the first control of a batch becomes pending. If a control is set again before the sender
+ * has sent it, only the latest value is sent and the overwritten value is counted as dropped.
+ * The sender passes each batch of pending values to the downstream sink as one frame.
+**/
+struct async_control_sink final : abc_control_sink{
+
+   /**
+    * @param downstream the sink to send from. Must only be used by the sender thread while running
+    **/
+   explicit async_control_sink(abc_control_sink & downstream);
+   ~async_control_sink();
+   async_control_sink(async_control_sink const &) = delete;
+   async_control_sink& operator =(async_control_sink const &) = delete;
+
+   /**
+    * @brief start the sender thread
+    **/
+   void start();
+
+   /**
+    * @brief stop the sender thread (done automatically in destructor).
+    * Values still pending are sent once before the thread exits
+    **/
+   void stop();
+
+   bool set_control(FlightDimension d, float_type const & value) override;
+
+   /**
+    * @brief number of controls waiting to be sent
+    **/
+   uint32_t get_queue_depth() const;
+
+   /**
+    * @brief number of values of control d overwritten before they were sent
+    **/
+   uint64_t get_num_dropped(FlightDimension d) const;
+   /**
+    * @brief total number of values overwritten before they were sent
+    **/
+   uint64_t get_num_dropped() const;
+
+   /// @brief number of frames sent downstream
+   uint64_t get_num_sent() const { return m_num_sent.load(std::memory_order_relaxed);}
+   /// @brief number of frames the downstream sink failed to send. They are retried,
+   /// and a failed value replaced by a newer one before the retry is not counted as dropped
+   uint64_t get_num_send_failures() const { return m_num_send_failures.load(std::memory_order_relaxed);}
+
+   static constexpr uint32_t num_slots = 8;
+private:
+   void run();
+   bool send(uint32_t pending);
+   void wait_for_pending(int timeout_ms);
+
+   abc_control_sink & m_downstream;
+   std::atomic<float_type> m_values[num_slots];
+   std::atomic<uint64_t> m_num_dropped[num_slots];
+   /// @brief bit n set if slot n has a value waiting to be sent
+   std::atomic<uint32_t> m_pending;
+   std::atomic<uint64_t> m_num_sent;
+   std::atomic<uint64_t> m_num_send_failures;
+   /// @brief wakes the sender when the first value becomes pending
+   int m_event_fd;
+   std::atomic<bool> m_running;
+   std::thread m_thread;
+};
+
+#endif // FG_EXT_ASYNC_CONTROL_SINK_HPP_INCLUDED
@@ -1,7 +1,16 @@
 #ifndef FDSHIM_NET_FLOAT_BYTE_ORDER_H_INCLUDED
 #define FDSHIM_NET_FLOAT_BYTE_ORDER_H_INCLUDED
 
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
 #include <arpa/inet.h>
+
+#if defined __SSSE3__
+#include <tmmintrin.h>
+#elif defined __ARM_NEON
+#include <arm_neon.h>
+#endif
 /*
 
    uint32_t htonl(uint32_t hostlong);
@@ -59,4 +68,73 @@ inline float ntohf(float x)
     return x;
 }
 
+/**
+ * @brief convert n 32 bit words ( uint32_t, int32_t or float) from network to host byte order
+ * Processes 4 words per instruction on SSSE3 and NEON.
+ * src and dst need not be aligned, but should not overlap unless equal
+**/
+inline void ntoh32_n(void* dst, void const * src, size_t n)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+   if ( dst != src){
+      ::memcpy(dst,src,n * 4);
+   }
+#else
+   auto* d = static_cast<uint8_t*>(dst);
+   auto const* s = static_cast<uint8_t const*>(src);
+   size_t i = 0;
+#if defined __SSSE3__
+   __m128i const shuffle = _mm_setr_epi8(3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12);
+   for ( ; i + 4 <= n; i += 4){
+      __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i * 4));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i * 4), _mm_shuffle_epi8(v,shuffle));
+   }
+#elif defined __ARM_NEON
+   for ( ; i + 4 <= n; i += 4){
+      vst1q_u8(d + i * 4,vrev32q_u8(vld1q_u8(s + i * 4)));
+   }
+#endif
+   for ( ; i < n; ++i){
+      uint32_t v;
+      ::memcpy(&v,s + i * 4, 4);
+      v = __builtin_bswap32(v);
+      ::memcpy(d + i * 4,&v, 4);
+   }
+#endif
+}
+
+/**
+ * @brief convert n 64 bit words ( uint64_t or double) from network to host byte order
+ * Processes 2 words per instruction on SSSE3 and NEON.
+**/
+inline void ntoh64_n(void* dst, void const * src, size_t n)
+{
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+   if ( dst != src){
+      ::memcpy(dst,src,n * 8);
+   }
+#else
+   auto* d = static_cast<uint8_t*>(dst);
+   auto const* s = static_cast<uint8_t const*>(src);
+   size_t i = 0;
+#if defined __SSSE3__
+   __m128i const shuffle = _mm_setr_epi8(7,6,5,4,3,2,1,0, 15,14,13,12,11,10,9,8);
+   for ( ; i + 2 <= n; i += 2){
+      __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(s + i * 8));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i * 8), _mm_shuffle_epi8(v,shuffle));
+   }
+#elif defined __ARM_NEON
+   for ( ; i + 2 <= n; i += 2){
+      vst1q_u8(d + i * 8,vrev64q_u8(vld1q_u8(s + i * 8)));
+   }
+#endif
+   for ( ; i < n; ++i){
+      uint64_t v;
+      ::memcpy(&v,s + i * 8, 8);
+      v = __builtin_bswap64(v);
+      ::memcpy(d + i * 8,&v, 8);
+   }
+#endif
+}
+
 #endif // FDSHIM_NET_FLOAT_BYTE_ORDER_H_INCLUDED
@@ -1,7 +1,7 @@
 #ifndef FG_EXT_FLIGHT_CONTROL_SOURCE_HPP_INCLUDED
 #define FG_EXT_FLIGHT_CONTROL_SOURCE_HPP_INCLUDED
 
-#include <quan/quantity_traits.hpp>
+#include <numeric_policy.hpp>
 #include <quan/constrain.hpp>
 #include "flight_dimensions.h"
 
@@ -11,10 +11,21 @@
 * flap will change Cm so affect pitch etc
 * These effects are dependent on the actual aircraft
 **/
+/**
+ * @brief constrain a control value to +-1 for signed and 0 to 1 for unsigned dimensions
+**/
+template <FlightDimension D>
+inline control_float_type constrain_control_value(control_float_type v)
+{
+   control_float_type constexpr min_value = flight_dimension_is_signed<D> ? -1 : 0;
+   control_float_type constexpr max_value = 1;
+   return quan::constrain(v,min_value,max_value);
+}
+
 template <FlightDimension D>
 struct control_dimension{
    static constexpr FlightDimension flight_dimension = D;
-   using float_type = quan::quantity_traits::default_value_type;
+   using float_type = control_float_type;
 
    /**
      * @brief get the value of the control_source dimension
@@ -22,10 +33,7 @@ struct control_dimension{
    **/
    float_type get() const
    { 
-      float_type constexpr min_value = flight_dimension_is_signed<D> ? -1 : 0;
-      float_type constexpr max_value = 1; 
-
-      return quan::constrain(get_impl(),min_value , max_value);
+      return constrain_control_value<D>(get_impl());
    }
    virtual ~control_dimension(){}
 protected: 
@@ -38,7 +46,7 @@ protected:
 **/
 template <FlightDimension D>
 struct default_control_dimension final : control_dimension<D>{
-   using float_type = quan::quantity_traits::default_value_type;
+   using float_type = control_float_type;
    float_type get_impl() const final
    {
       return 0;
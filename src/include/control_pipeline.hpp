@@ -0,0 +1,265 @@
+#ifndef FG_EXT_CONTROL_PIPELINE_HPP_INCLUDED
+#define FG_EXT_CONTROL_PIPELINE_HPP_INCLUDED
+
+#include <type_traits>
+#include <utility>
+#include <control_source_concept.hpp>
+#include <control_dimension.hpp>
+#include <control_sink.hpp>
+#include <joystick_dimension.hpp>
+#include <flight_controller.hpp>
+
+/**
+ * @file control sources, mixers and limiters chained at compile time through the control_source concept.
+ * Each stage reads its inputs with get<FlightDimension>(), so a whole pipeline inlines into
+ * static_flight_controller with no virtual calls, the sink included if its type is final.
+ * A stage given an lvalue holds it by reference, e.g the joystick_t, and a temporary by value.
+ * control_dimension_adapter and pipeline_flight_controller put a pipeline behind the virtual interface.
+**/
+
+namespace detail{
+
+   template <typename T, typename = void>
+   inline constexpr bool has_control_source_update = false;
+
+   template <typename T>
+   inline constexpr bool has_control_source_update<
+      T, std::void_t<decltype(std::declval<T&>().update())>
+   > = true;
+}
+
+/**
+ * @brief call the source update() if it has one, e.g joystick_t takes a snapshot.
+ * A source held by const reference is not updated
+**/
+template <typename Src>
+inline void update_control_source(Src & source)
+{
+   if constexpr ( detail::has_control_source_update<Src>){
+      source.update();
+   }
+}
+
+/**
+ * @brief source mapped from a joystick snapshot owned elsewhere, not constrained. Needs no device
+**/
+struct joystick_state_source{
+
+   explicit joystick_state_source(joystick_state const & js)
+   : m_joystick{js}{}
+
+   template <FlightDimension D>
+   control_float_type get() const { return get_joystick_axis_value<D>(m_joystick);}
+
+private:
+   joystick_state const & m_joystick;
+};
+
+/**
+ * @brief source with a value set for each dimension, 0 by default. e.g trims, or a fixed throttle
+**/
+struct constant_source{
+
+   constexpr constant_source() : m_values{} {}
+
+   void set(FlightDimension d, control_float_type value) { m_values[static_cast<int>(d)] = value;}
+
+   template <FlightDimension D>
+   control_float_type get() const { return m_values[static_cast<int>(D)];}
+
+private:
+   control_float_type m_values[8];
+};
+
+/**
+ * @brief weighted sum of two sources in each dimension, e.g autopilot plus pilot, or stick plus trim.
+ * Weights are 1 by default
+**/
+template <control_source A, control_source B>
+struct mixer{
+
+   template <typename SA, typename SB>
+   mixer(SA && a, SB && b)
+   : m_a{std::forward<SA>(a)},
+     m_b{std::forward<SB>(b)}
+   {
+      for ( auto & w : m_weight_a){ w = 1;}
+      for ( auto & w : m_weight_b){ w = 1;}
+   }
+
+   void set_weights(FlightDimension d, control_float_type weight_a, control_float_type weight_b)
+   {
+      m_weight_a[static_cast<int>(d)] = weight_a;
+      m_weight_b[static_cast<int>(d)] = weight_b;
+   }
+
+   template <FlightDimension D>
+   control_float_type get() const
+   {
+      return m_a.template get<D>() * m_weight_a[static_cast<int>(D)] +
+         m_b.template get<D>() * m_weight_b[static_cast<int>(D)];
+   }
+
+   void update()
+   {
+      update_control_source(m_a);
+      update_control_source(m_b);
+   }
+
+private:
+   A m_a;
+   B m_b;
+   control_float_type m_weight_a[8];
+   control_float_type m_weight_b[8];
+};
+
+template <typename SA, typename SB>
+mixer(SA &&, SB &&) -> mixer<SA, SB>;
+
+/**
+ * @brief constrain the source to +-1 for signed and 0 to 1 for unsigned dimensions, as control_dimension::get
+**/
+template <control_source Src>
+struct limiter{
+
+   template <typename S>
+   explicit limiter(S && source)
+   : m_source{std::forward<S>(source)}{}
+
+   template <FlightDimension D>
+   control_float_type get() const { return constrain_control_value<D>(m_source.template get<D>());}
+
+   void update() { update_control_source(m_source);}
+
+private:
+   Src m_source;
+};
+
+template <typename S>
+limiter(S &&) -> limiter<S>;
+
+namespace detail{
+
+   template <>
+   inline constexpr bool is_control_source_impl<joystick_state_source> = true;
+
+   template <>
+   inline constexpr bool is_control_source_impl<constant_source> = true;
+
+   template <typename A, typename B>
+   inline constexpr bool is_control_source_impl<mixer<A,B> > = true;
+
+   template <typename Src>
+   inline constexpr bool is_control_source_impl<limiter<Src> > = true;
+}
+
+/**
+ * @brief send the controls from a pipeline to a sink each frame, with the same control_sender as
+ * abc_flight_controller::update but no virtual calls. Sink must be a final abc_control_sink so its calls are resolved statically
+**/
+template <control_source Src, typename Sink>
+struct static_flight_controller{
+
+   static_assert(std::is_base_of_v<abc_control_sink,Sink> && std::is_final_v<Sink>,
+      "static_flight_controller : Sink must be a final abc_control_sink");
+
+   using float_type = control_float_type;
+
+   template <typename S>
+   static_flight_controller(S && source, Sink & sink)
+   : m_source{std::forward<S>(source)},
+     m_sender{sink}
+   {}
+
+   /**
+    * @brief update the sources, then send the controls
+    **/
+   bool update()
+   {
+      return m_sender.update(
+         [this]{ update_control_source(m_source); return true;},
+         [this]{ return send_controls();}
+      );
+   }
+
+   /**
+    * @brief send the controls from the current source values, with no timing
+    **/
+   bool send_controls()
+   {
+      return m_sender.send_controls(
+         m_source.template get<FlightDimension::Roll>(),
+         m_source.template get<FlightDimension::Pitch>(),
+         m_source.template get<FlightDimension::Yaw>(),
+         m_source.template get<FlightDimension::Throttle>()
+      );
+   }
+
+   Src & get_source() { return m_source;}
+   Src const & get_source() const { return m_source;}
+
+   /**
+    * @brief record the control values output by each update. nullptr to stop recording
+    **/
+   void set_recorder(flight_recorder* recorder) { m_sender.set_recorder(recorder);}
+
+private:
+   Src m_source;
+   control_sender<Sink> m_sender;
+};
+
+template <typename S, typename Sink>
+static_flight_controller(S &&, Sink &) -> static_flight_controller<S, Sink>;
+
+/**
+ * @brief dimension D of a pipeline as a virtual control_dimension
+**/
+template <control_source Src, FlightDimension D>
+struct control_dimension_adapter final : control_dimension<D>{
+
+   explicit control_dimension_adapter(Src const & source)
+   : m_source{source}{}
+
+   using float_type = control_float_type;
+   float_type get_impl() const final { return m_source.template get<D>();}
+
+private:
+   Src const & m_source;
+};
+
+/**
+ * @brief a pipeline as an abc_flight_controller, for code that switches controllers at runtime.
+ * The sources are updated in pre_update
+**/
+template <control_source Src>
+struct pipeline_flight_controller final : abc_flight_controller{
+
+   template <typename S>
+   pipeline_flight_controller(abc_control_sink & sink, S && source)
+   : abc_flight_controller{sink},
+     m_source{std::forward<S>(source)}
+   {}
+
+   bool pre_update(fdm_state const & fdm, quan::time::ms const & time_step) override
+   {
+      update_control_source(m_source);
+      return true;
+   }
+
+   float_type get_roll() const override { return m_source.template get<FlightDimension::Roll>();}
+   float_type get_pitch() const override { return m_source.template get<FlightDimension::Pitch>();}
+   float_type get_yaw() const override { return m_source.template get<FlightDimension::Yaw>();}
+   float_type get_throttle() const override { return m_source.template get<FlightDimension::Throttle>();}
+   float_type get_spoiler() const override { return m_source.template get<FlightDimension::Spoiler>();}
+   float_type get_flap() const override { return m_source.template get<FlightDimension::Flap>();}
+
+   Src & get_source() { return m_source;}
+
+private:
+   Src m_source;
+};
+
+template <typename S>
+pipeline_flight_controller(abc_control_sink &, S &&) -> pipeline_flight_controller<S>;
+
+#endif // FG_EXT_CONTROL_PIPELINE_HPP_INCLUDED
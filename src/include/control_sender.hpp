@@ -0,0 +1,86 @@
+#ifndef FG_EXT_CONTROL_SENDER_HPP_INCLUDED
+#define FG_EXT_CONTROL_SENDER_HPP_INCLUDED
+
+#include <cstdio>
+#include <cstdint>
+#include <control_sink.hpp>
+#include <latency_histogram.hpp>
+#include <flight_recorder.hpp>
+
+/**
+ * @brief the per frame work common to abc_flight_controller and static_flight_controller.
+ * Times the update, sends the controls to the sink when they change and records them.
+ * Sink is abc_control_sink for virtual sink calls, or a final sink type so they are resolved statically
+**/
+template <typename Sink>
+struct control_sender{
+
+   using float_type = control_float_type;
+
+   explicit control_sender(Sink & sink)
+   : m_sink{sink}{}
+
+   /**
+    * @brief run pre_update(), then if it returns true send(), timed as the PreUpdate and SetControl stages.
+    * An exception from either is reported and returns false
+    **/
+   template <typename PreUpdate, typename Send>
+   bool update(PreUpdate && pre_update, Send && send)
+   {
+      try {
+         int64_t const t0 = get_time_ns(CLOCK_MONOTONIC);
+         bool result = pre_update();
+         int64_t const t1 = get_time_ns(CLOCK_MONOTONIC);
+         record_latency(latency_stage::PreUpdate, t1 - t0);
+         if ( !result){
+            return false;
+         }
+         result = send();
+         record_latency(latency_stage::SetControl, get_time_ns(CLOCK_MONOTONIC) - t1);
+         return result;
+      }catch(...){
+         fprintf(stderr,"set controls failed\n");
+         return false;
+      }
+   }
+
+   /**
+    * @brief send one frame of controls to the sink, then record them
+    **/
+   bool send_controls(float_type roll, float_type pitch, float_type yaw, float_type throttle)
+   {
+      bool const result = m_sink.begin_frame() &&
+         set_control(FlightDimension::Roll,roll) &&
+         set_control(FlightDimension::Pitch,pitch) &&
+         set_control(FlightDimension::Yaw,yaw) &&
+         set_control(FlightDimension::Throttle,throttle) &&
+         m_sink.end_frame();
+      if ( m_recorder != nullptr){
+         m_recorder->record_controls(roll,pitch,yaw,throttle);
+      }
+      return result;
+   }
+
+   /**
+    * @brief record the control values output by each frame. nullptr to stop recording
+    **/
+   void set_recorder(flight_recorder* recorder) { m_recorder = recorder;}
+
+private:
+   /// @brief only send a control to the sink if its value changed
+   bool set_control(FlightDimension d, float_type const & latest)
+   {
+      float_type & cached = m_flight_controls_cache[static_cast<int>(d)];
+      if ( latest == cached){
+         return true;
+      }else{
+         cached = latest;
+         return m_sink.set_control(d,latest);
+      }
+   }
+   Sink & m_sink;
+   flight_recorder* m_recorder = nullptr;
+   float_type m_flight_controls_cache[8] = {0.0};
+};
+
+#endif // FG_EXT_CONTROL_SENDER_HPP_INCLUDED
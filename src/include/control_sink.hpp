@@ -0,0 +1,43 @@
+#ifndef FG_EXT_CONTROL_SINK_HPP_INCLUDED
+#define FG_EXT_CONTROL_SINK_HPP_INCLUDED
+
+#include <cstdint>
+#include <numeric_policy.hpp>
+#include "flight_dimensions.h"
+
+/**
+ * @brief destination for the control values output by a flight controller each frame
+ * e.g FlightGear via telnet, or a stub for offline replay
+**/
+struct abc_control_sink{
+
+   using float_type = control_float_type;
+
+   /**
+    * @brief called once per frame before any set_control
+    **/
+   virtual bool begin_frame() { return true;}
+
+   /**
+    * @brief set the value of a control. Only called when the value has changed
+    **/
+   virtual bool set_control(FlightDimension d, float_type const & value) = 0;
+
+   /**
+    * @brief called once per frame after the set_control calls
+    **/
+   virtual bool end_frame() { return true;}
+
+   virtual ~abc_control_sink(){}
+protected:
+   constexpr abc_control_sink(){}
+};
+
+/**
+ * @brief sink that ignores all control values
+**/
+struct null_control_sink final : abc_control_sink{
+   bool set_control(FlightDimension , float_type const & ) override { return true;}
+};
+
+#endif // FG_EXT_CONTROL_SINK_HPP_INCLUDED
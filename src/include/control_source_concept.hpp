@@ -1,7 +1,9 @@
 #ifndef FG_EXT_CONTROL_SOURCE_CONCEPT_HPP_INCLUDED
 #define FG_EXT_CONTROL_SOURCE_CONCEPT_HPP_INCLUDED
 
+#include <cstdint>
 #include <type_traits>
+#include "flight_dimensions.h"
 
  namespace detail{
    
@@ -9,9 +11,16 @@
     inline constexpr bool is_control_source_impl = false;
  }
 
+/**
+ * @brief a type registered in detail::is_control_source_impl, with the value of each dimension
+ * from a non virtual member template get<FlightDimension>() const
+ * N.B. requirement is checked for Roll only
+**/
 template <typename T>
 concept control_source = detail::is_control_source_impl<
    std::remove_cvref_t<T>
->;
+> && requires ( std::remove_cvref_t<T> const & t){
+   t.template get<FlightDimension::Roll>();
+};
 
 #endif // FG_EXT_CONTROL_SOURCE_CONCEPT_HPP_INCLUDED
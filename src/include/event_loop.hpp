@@ -0,0 +1,92 @@
+#ifndef FG_EXT_EVENT_LOOP_HPP_INCLUDED
+#define FG_EXT_EVENT_LOOP_HPP_INCLUDED
+
+#include <cstdint>
+#include <functional>
+#include <sys/timerfd.h>
+#include <quan/time.hpp>
+
+struct fixed_rate_scheduler;
+
+/**
+ * @brief epoll based event loop.
+ * Waits on any number of file descriptors (fdm socket, telnet socket, joystick etc)
+ * and periodic timers (timerfd) at once, and dispatches each to its callback as soon as it is ready,
+ * so there is no need to guess how long to sleep until the next fdm packet
+ * Callbacks are run on the thread that calls run()
+**/
+struct event_loop{
+
+   using fd_callback_t = std::function<void()>;
+   /// @brief timer callback arg is the number of timer periods expired since last call ( usually 1)
+   using timer_callback_t = std::function<void(uint64_t)>;
+
+   event_loop();
+   ~event_loop();
+   event_loop(event_loop const &) = delete;
+   event_loop& operator =(event_loop const &) = delete;
+
+   /**
+    * @brief call cb whenever fd is readable.
+    * The fd is level triggered, so cb should read all available data
+    **/
+   void add_fd(int fd, fd_callback_t const & cb);
+
+   /**
+    * @brief stop watching fd.
+    * Can be called from any callback, including the one for fd. Its callback isnt called again,
+    * but is only destroyed once the current dispatch is done
+    **/
+   void remove_fd(int fd);
+
+   /**
+    * @brief call cb every period. First call is one period from now
+    * @return the timerfd, which can be passed to remove_fd
+    **/
+   int add_timer(quan::time::us const & period, timer_callback_t const & cb);
+
+   /**
+    * @brief restart the scheduler and call cb at each of its deadlines, the first one period from now.
+    * The scheduler records the jitter and overruns of each call. It must outlive the timer
+    * @return the timerfd, which can be passed to remove_fd
+    **/
+   int add_timer(fixed_rate_scheduler & scheduler, timer_callback_t const & cb);
+
+   /**
+    * @brief dispatch events until stop() is called
+    **/
+   void run();
+
+   /**
+    * @brief wait up to timeout for events and dispatch them
+    * @return number of events dispatched
+    **/
+   int run_once(quan::time::ms const & timeout);
+
+   /**
+    * @brief make run() return after the current callback. Only call from a callback
+    **/
+   void stop() { m_running = false;}
+
+   static constexpr uint32_t max_handlers = 16;
+private:
+   struct handler{
+      int fd = -1;
+      bool is_timer = false;
+      /// @brief removed during dispatch. The slot is free once the callbacks are destroyed
+      bool release_pending = false;
+      fd_callback_t on_readable;
+      timer_callback_t on_timer;
+   };
+   uint32_t add_handler(int fd);
+   int add_timerfd(itimerspec const & spec, int flags, timer_callback_t const & cb);
+   int wait_and_dispatch(int timeout_ms);
+   void release_removed_handlers();
+
+   int m_epoll_fd;
+   bool m_running;
+   bool m_dispatching;
+   handler m_handlers[max_handlers];
+};
+
+#endif // FG_EXT_EVENT_LOOP_HPP_INCLUDED
@@ -0,0 +1,30 @@
+#ifndef FG_EXT_FAST_ATAN2_HPP_INCLUDED
+#define FG_EXT_FAST_ATAN2_HPP_INCLUDED
+
+#include <cmath>
+
+/**
+ * @brief polynomial approximation of std::atan2 in float, for when libm atan2 dominates the frame time.
+ * atan of the smaller over the larger of |x| and |y| from a minimax polynomial ( Abramowitz and Stegun 4.4.49)
+ * then the quadrant fixed up. Only arithmetic and selects, no libm calls, so loops calling it can be vectorised.
+ * Worst case error against std::atan2 is fast_atan2_max_error, 1.2e-5 rad ( 0.0007 deg), over the whole circle.
+ * atan2(0,0) returns 0 as std::atan2. Infinities and nans are not handled.
+**/
+constexpr float fast_atan2_max_error = 1.2e-5f;
+
+inline float fast_atan2(float y, float x)
+{
+   constexpr float pi = 3.14159265f;
+   float const ax = std::fabs(x);
+   float const ay = std::fabs(y);
+   float const mx = (ax > ay) ? ax : ay;
+   float const mn = (ax > ay) ? ay : ax;
+   float const a = (mx > 0.f) ? mn / mx : 0.f;
+   float const s = a * a;
+   float r = a * (0.9998660f + s * (-0.3302995f + s * (0.1801410f + s * (-0.0851330f + s * 0.0208351f))));
+   r = (ay > ax) ? (pi / 2.f - r) : r;
+   r = (x < 0.f) ? (pi - r) : r;
+   return std::copysign(r,y);
+}
+
+#endif // FG_EXT_FAST_ATAN2_HPP_INCLUDED
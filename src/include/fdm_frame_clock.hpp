@@ -0,0 +1,63 @@
+#ifndef FG_EXT_FDM_FRAME_CLOCK_HPP_INCLUDED
+#define FG_EXT_FDM_FRAME_CLOCK_HPP_INCLUDED
+
+#include <cstdint>
+#include <ctime>
+#include <quan/time.hpp>
+
+/**
+ * @brief estimate the period and phase of FlightGear's fdm output from the packet arrival times.
+ * A second order phase locked loop predicts the arrival time of each packet and corrects
+ * its phase and period from the prediction error, so the period follows the real fdm rate
+ * rather than the rate on the FlightGear command line, and arrival jitter is filtered out.
+ * The fdm cur_time ( FlightGear time in whole seconds) is used to count the packets per
+ * simulated second, which bounds the period if arrivals are badly disturbed.
+ * Lost packets are detected as a prediction error of a whole number of periods.
+**/
+struct fdm_frame_clock{
+
+   /**
+    * @param nominal_period the expected period, used until the loop locks e.g 1/ --native-fdm rate
+    **/
+   explicit fdm_frame_clock(quan::time::ms const & nominal_period);
+
+   /**
+    * @brief call with each fdm packet received
+    * @param arrival_time kernel receive time of the packet ( CLOCK_REALTIME) from fgfs_fdm_in::get_arrival_time
+    * @param cur_time the fdm cur_time field
+    **/
+   void update(timespec const & arrival_time, uint32_t cur_time);
+
+   /**
+    * @brief the measured fdm period, or the nominal period until locked.
+    * Use as the controller time step
+    **/
+   quan::time::ms get_period() const;
+
+   /// @brief true once the prediction error has settled to a small fraction of the period
+   bool is_locked() const;
+
+   /// @brief arrival time of the last packet minus its predicted arrival time
+   int64_t get_phase_error_ns() const { return m_phase_error_ns;}
+   /// @brief number of packets that didnt arrive when expected
+   uint64_t get_num_lost() const { return m_num_lost;}
+   /// @brief packets counted in the last whole simulated second, 0 if not known yet
+   uint32_t get_frames_per_sim_second() const { return m_frames_per_sim_second;}
+
+private:
+   void update_sim_second(uint32_t cur_time);
+   void constrain_period();
+
+   double m_nominal_period_ns;
+   double m_period_ns;
+   int64_t m_predicted_ns;
+   int64_t m_phase_error_ns;
+   double m_mean_abs_error_ns;
+   uint64_t m_num_frames;
+   uint64_t m_num_lost;
+   uint32_t m_cur_time;
+   uint32_t m_frames_this_sim_second;
+   uint32_t m_frames_per_sim_second;
+};
+
+#endif // FG_EXT_FDM_FRAME_CLOCK_HPP_INCLUDED
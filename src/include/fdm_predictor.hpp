@@ -0,0 +1,52 @@
+#ifndef FG_EXT_FDM_PREDICTOR_HPP_INCLUDED
+#define FG_EXT_FDM_PREDICTOR_HPP_INCLUDED
+
+#include <fdm_state.hpp>
+#include <quan/time.hpp>
+
+/**
+ * @brief extrapolate the fdm state between packets, so a controller can run faster than the fdm rate.
+ * The attitude is advanced as a quaternion, rotated at the body rates derived from the
+ * euler rates of the last packet. The NED velocity is advanced by the pilot accelerations
+ * ( rotated to NED, plus gravity) and the position by the NED velocity.
+ * The body velocity is advanced by the same acceleration and rotated to the predicted attitude.
+ * Other values are held at the last packet.
+ * No allocation. The per packet work is done in reset, so predict is cheap.
+**/
+struct fdm_predictor{
+
+   fdm_predictor();
+
+   /**
+    * @brief start extrapolating from a newly received fdm
+    **/
+   void reset(fdm_state const & fdm);
+
+   /**
+    * @param dt time since the packet passed to reset
+    * @return the predicted state at dt. Valid until the next call
+    **/
+   fdm_state const & predict(quan::time::us const & dt);
+
+   /// @brief the last packet passed to reset
+   fdm_state const & get_base() const { return m_base;}
+
+private:
+   fdm_state m_base;
+   fdm_state m_predicted;
+   /// @brief attitude of the last packet, body to NED, w,x,y,z
+   float m_q0[4];
+   /// @brief body rates p, q, r of the last packet in rad/s
+   float m_body_rate[3];
+   /// @brief magnitude of m_body_rate
+   float m_body_rate_mag;
+   /// @brief acceleration in the NED frame in m/s2 including gravity
+   float m_accel_ned[3];
+   /// @brief body velocity of the last packet in the NED frame
+   float m_velocity_body_ned[3];
+   /// @brief rad of latitude, longitude per m north, east at the last packet
+   double m_rad_per_m_north;
+   double m_rad_per_m_east;
+};
+
+#endif // FG_EXT_FDM_PREDICTOR_HPP_INCLUDED
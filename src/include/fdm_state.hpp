@@ -0,0 +1,72 @@
+#ifndef FG_EXT_FDM_STATE_HPP_INCLUDED
+#define FG_EXT_FDM_STATE_HPP_INCLUDED
+
+#include <net_fdm.hxx>
+#include <autoconv_net_fdm.hpp>
+
+#include <quan/length.hpp>
+#include <quan/angle.hpp>
+#include <quan/velocity.hpp>
+#include <quan/acceleration.hpp>
+#include <quan/reciprocal_time.hpp>
+#include <quan/three_d/vect.hpp>
+
+/**
+ * @brief The fdm decoded once per frame to host byte order and SI units.
+ * Unlike autoconv_FGNetFDM, reading a member costs nothing, so controllers can read
+ * the same values as often as they like.
+ * Related values are grouped as x, y, z vectors
+**/
+struct fdm_state{
+
+   template <typename T = float>
+   using rad = typename quan::angle_<T>::rad;
+
+   template <typename T = float>
+   using rad_per_s = typename quan::reciprocal_time_<
+      rad<T>
+   >::per_s ;
+
+   using m = quan::length_<float>::m;
+   using m_per_s = quan::velocity_<float>::m_per_s;
+   using m_per_s2 = quan::acceleration_<float>::m_per_s2;
+
+   // Positions
+   rad<double> longitude;                   // geodetic
+   rad<double> latitude;                    // geodetic
+   quan::length_<double>::m altitude;       // above sea level
+   m agl;                                   // above ground level
+
+   /// @brief euler angles x = roll (phi), y = pitch (theta), z = yaw or true heading (psi)
+   quan::three_d::vect<rad<> > attitude;
+   rad<> alpha;                             // angle of attack
+   rad<> beta;                              // side slip angle
+
+   /// @brief euler angle rates x = phidot, y = thetadot, z = psidot
+   quan::three_d::vect<rad_per_s<> > attitude_rate;
+
+   m_per_s vcas;                            // calibrated airspeed
+   m_per_s climb_rate;
+   /// @brief x = north, y = east, z = down
+   quan::three_d::vect<m_per_s> velocity_ned;
+   /// @brief x = u, y = v, z = w
+   quan::three_d::vect<m_per_s> velocity_body;
+   /// @brief pilot accelerations in body frame
+   quan::three_d::vect<m_per_s2> accel_body;
+
+   uint32_t cur_time;                       // unix time
+
+   /**
+    * @brief the whole packet in host byte order but original FlightGear units,
+    * for the less used values ( engines, gear, control surfaces etc)
+    **/
+   FGNetFDM raw;
+};
+
+/**
+ * @brief convert the whole received packet in one pass
+ * The byte swapping is done in bulk, vectorised where possible
+**/
+void decode_fdm(autoconv_FGNetFDM const & in, fdm_state & out);
+
+#endif // FG_EXT_FDM_STATE_HPP_INCLUDED
@@ -0,0 +1,57 @@
+#ifndef FG_EXT_FGFS_CTRLS_OUT_HPP_INCLUDED
+#define FG_EXT_FGFS_CTRLS_OUT_HPP_INCLUDED
+
+#include <cstdint>
+#include <netinet/in.h>
+#include <autoconv_net_ctrls.hpp>
+#include <control_sink.hpp>
+
+/**
+ * @brief send control values to FlightGear as one binary FGNetCtrls datagram per frame
+ * FlightGear must be started with --native-ctrls=socket,in,<hz>,,<port>,udp
+ * N.B. FlightGear applies every field of the packet, not just the flight controls,
+ * so the other fields are set to sane defaults ( engines running, speedup 1, standard atmosphere etc).
+ * Use get_ctrls() to change them.
+**/
+struct fgfs_ctrls_out final : abc_control_sink{
+
+   static constexpr int32_t default_port = 5700;
+
+   fgfs_ctrls_out(const char* hostname, int32_t port = default_port);
+   ~fgfs_ctrls_out();
+   fgfs_ctrls_out(fgfs_ctrls_out const &) = delete;
+   fgfs_ctrls_out& operator =(fgfs_ctrls_out const &) = delete;
+
+   /**
+    * @brief update the control in the packet. Nothing is sent until end_frame
+    **/
+   bool set_control(FlightDimension d, float_type const & value) override;
+
+   /**
+    * @brief send the packet
+    * A datagram that cant be sent because FlightGear isnt listening yet or the
+    * socket buffer is full is dropped and counted, since the next frame supersedes it
+    * @return false on other errors
+    **/
+   bool end_frame() override;
+
+   /**
+    * @brief the packet sent each frame, to change the non flight control values
+    **/
+   autoconv_FGNetCtrls & get_ctrls() { return m_ctrls;}
+
+   int get_fd() const { return m_socket_fd;}
+
+   uint64_t get_num_sent() const { return m_num_sent;}
+   uint64_t get_num_dropped() const { return m_num_dropped;}
+
+   void close();
+private:
+   autoconv_FGNetCtrls m_ctrls;
+   int m_socket_fd;
+   sockaddr_in m_address;
+   uint64_t m_num_sent;
+   uint64_t m_num_dropped;
+};
+
+#endif // FG_EXT_FGFS_CTRLS_OUT_HPP_INCLUDED
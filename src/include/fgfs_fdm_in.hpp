@@ -1,7 +1,9 @@
 #ifndef FG_EXTERNAL_TEST_FGFS_FDM_IN_HPP_INCLUDED
 #define FG_EXTERNAL_TEST_FGFS_FDM_IN_HPP_INCLUDED
 
+#include <ctime>
 #include <sys/socket.h>
+#include <netinet/in.h>
 #include <autoconv_net_fdm.hpp>
 #include <quan/time.hpp>
 
@@ -15,20 +17,64 @@ struct fgfs_fdm_in{
    /**
     * @briefget the latest version of the fdm from flighgear
     * blocks indefinitely
-    *
+    * @return false if the datagram read was not exactly the size of an fdm
     **/
    bool update();
 
+   /**
+    * @brief drain all fdm packets queued on the socket in one syscall, keeping only the newest
+    * blocks until at least one packet is available.
+    * Older packets, and datagrams that are not exactly the size of an fdm, are discarded and counted in get_num_skipped()
+    * @return true if a new fdm was received
+    **/
+   bool update_latest();
+
    /**
     * @brief check if new fdm data is available from flightgear
     * @return true if data is available (update() would not block) else false
-    **/ 
+    **/
    bool poll(quan::time::s const & t)const;
+
+   /**
+    * @brief make update_latest() give up and return false if no packet arrives within t
+    **/
+   void set_receive_timeout(quan::time::ms const & t);
    autoconv_FGNetFDM const & get_fdm()const { return fdm;}
+
+   /**
+    * @brief the socket file descriptor, e.g for an event_loop
+    **/
+   int get_fd() const { return m_socket_fd;}
+
+   /**
+    * @brief kernel receive time of the fdm returned by get_fdm(), on CLOCK_REALTIME
+    * Only set by update_latest()
+    **/
+   timespec const & get_arrival_time() const { return m_arrival_time;}
+
+   /**
+    * @brief total number of stale packets discarded by update_latest()
+    * A steadily rising count means the control loop is not keeping up with FlightGear
+    **/
+   uint64_t get_num_skipped() const { return m_num_skipped;}
+   /**
+    * @brief number of stale packets discarded by the last call to update_latest()
+    **/
+   uint32_t get_last_skipped() const { return m_last_skipped;}
+
+   /**
+    * @brief max number of packets read from the socket by one update_latest()
+    **/
+   static constexpr uint32_t max_batch = 16;
 private:
    autoconv_FGNetFDM fdm;
    int m_socket_fd;
    sockaddr_in m_address;
+   uint64_t m_num_skipped;
+   uint32_t m_last_skipped;
+   timespec m_arrival_time;
+   /// @brief receive buffers for update_latest()
+   autoconv_FGNetFDM m_batch[max_batch];
 };
 
 #endif // FG_EXTERNAL_TEST_FGFS_FDM_IN_HPP_INCLUDED
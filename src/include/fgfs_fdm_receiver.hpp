@@ -0,0 +1,88 @@
+#ifndef FG_EXT_FGFS_FDM_RECEIVER_HPP_INCLUDED
+#define FG_EXT_FGFS_FDM_RECEIVER_HPP_INCLUDED
+
+#include <atomic>
+#include <thread>
+#include <fgfs_fdm_in.hpp>
+#include <seqlock.hpp>
+
+/**
+ * @brief receive fdm packets from FlightGear on a dedicated thread and publish each
+ * complete frame through a seqlock.
+ * Controllers, loggers and displays on other threads can each take a consistent snapshot
+ * with get_fdm() without locking and without stalling the receive thread
+**/
+struct fgfs_fdm_receiver{
+
+   fgfs_fdm_receiver(const char* hostname, int32_t port);
+   ~fgfs_fdm_receiver();
+   fgfs_fdm_receiver(fgfs_fdm_receiver const &) = delete;
+   fgfs_fdm_receiver& operator =(fgfs_fdm_receiver const &) = delete;
+
+   /**
+    * @brief start the receive thread
+    **/
+   void start();
+
+   /**
+    * @brief stop the receive thread (done automatically in destructor)
+    **/
+   void stop();
+
+   /**
+    * @brief get a consistent copy of the latest fdm. Can be called from any thread
+    * @return frame number of the copy, 0 if no fdm has been received yet
+    **/
+   uint32_t get_fdm(autoconv_FGNetFDM & fdm) const
+   {
+      timespec arrival_time;
+      return get_fdm(fdm,arrival_time);
+   }
+
+   /**
+    * @brief as get_fdm(fdm) but also get the kernel receive time of the fdm ( CLOCK_REALTIME)
+    **/
+   uint32_t get_fdm(autoconv_FGNetFDM & fdm, timespec & arrival_time) const
+   {
+      frame f;
+      uint32_t const result = m_fdm.load(f);
+      fdm = f.fdm;
+      arrival_time = f.arrival_time;
+      return result;
+   }
+
+   /**
+    * @brief number of frames published so far
+    **/
+   uint32_t get_frame_count() const { return m_fdm.get_count();}
+
+   /**
+    * @brief block until a frame newer than last_frame is published
+    * @return true if there is a newer frame, false on timeout
+    **/
+   bool wait_for_frame(uint32_t last_frame, quan::time::ms const & timeout) const;
+
+   /**
+    * @brief total number of stale packets discarded by the receive thread
+    **/
+   uint64_t get_num_skipped() const { return m_num_skipped.load(std::memory_order_relaxed);}
+
+private:
+   void run();
+
+   struct frame{
+      autoconv_FGNetFDM fdm;
+      timespec arrival_time;
+   };
+
+   fgfs_fdm_in m_fdm_in;
+   seqlock<frame> m_fdm;
+   /// @brief futex word. Mirrors the seqlock frame count for waiters
+   mutable std::atomic<uint32_t> m_frame_count;
+   mutable std::atomic<uint32_t> m_num_waiters;
+   std::atomic<uint64_t> m_num_skipped;
+   std::atomic<bool> m_running;
+   std::thread m_thread;
+};
+
+#endif // FG_EXT_FGFS_FDM_RECEIVER_HPP_INCLUDED
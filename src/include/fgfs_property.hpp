@@ -0,0 +1,140 @@
+#ifndef FG_EXT_FGFS_PROPERTY_HPP_INCLUDED
+#define FG_EXT_FGFS_PROPERTY_HPP_INCLUDED
+
+#include <cstdint>
+#include <cstddef>
+#include "flight_dimensions.h"
+
+/**
+ * @file compile time registry of the FlightGear properties we use.
+ * Each property has an id, and its path and telnet "set <path> " command prefix
+ * are rendered at compile time, so sending a set only needs the value appended.
+**/
+
+enum class fgfs_prop : uint8_t {
+   Aileron,
+   Elevator,
+   Rudder,
+   Throttle,
+   Flaps,
+   Spoilers,
+   FrameRate,
+   NumProps
+};
+
+namespace fgfs_property_detail{
+
+   static constexpr size_t max_path_len = 64;
+   static constexpr char set_command[] = "set ";
+   static constexpr size_t set_command_len = sizeof(set_command) - 1;
+
+   struct property_strings{
+      char path[max_path_len];
+      char set_prefix[max_path_len + set_command_len + 1];
+      size_t path_len;
+      size_t set_prefix_len;
+   };
+
+   constexpr size_t string_length(const char* str)
+   {
+      size_t len = 0;
+      while ( str[len] != '\0'){
+         ++len;
+      }
+      return len;
+   }
+
+   /**
+    * @brief render the path and set prefix. A path that is too long fails to compile
+    **/
+   constexpr property_strings make_property(const char* path)
+   {
+      property_strings result{};
+      size_t const len = string_length(path);
+      if ( len >= max_path_len){
+         throw "fgfs_property : path too long";
+      }
+      for ( size_t i = 0; i < len; ++i){
+         result.path[i] = path[i];
+      }
+      result.path_len = len;
+      for ( size_t i = 0; i < set_command_len; ++i){
+         result.set_prefix[i] = set_command[i];
+      }
+      for ( size_t i = 0; i < len; ++i){
+         result.set_prefix[set_command_len + i] = path[i];
+      }
+      result.set_prefix[set_command_len + len] = ' ';
+      result.set_prefix_len = set_command_len + len + 1;
+      return result;
+   }
+
+   /**
+    * @brief in fgfs_prop order
+    **/
+   static constexpr property_strings properties[] = {
+      make_property("/controls/flight/aileron"),
+      make_property("/controls/flight/elevator"),
+      make_property("/controls/flight/rudder"),
+      make_property("/controls/engines/engine[0]/throttle"),
+      make_property("/controls/flight/flaps"),
+      make_property("/controls/flight/spoilers"),
+      make_property("/sim[0]/frame-rate")
+   };
+
+   static_assert( (sizeof(properties) / sizeof(properties[0])) 
+      == static_cast<size_t>(fgfs_prop::NumProps),"fgfs_property : a property is missing from the table");
+}
+
+/**
+ * @brief the property path e.g "/controls/flight/aileron"
+**/
+constexpr const char* get_path(fgfs_prop p)
+{
+   return fgfs_property_detail::properties[static_cast<size_t>(p)].path;
+}
+
+constexpr size_t get_path_len(fgfs_prop p)
+{
+   return fgfs_property_detail::properties[static_cast<size_t>(p)].path_len;
+}
+
+/**
+ * @brief the telnet set command up to the value e.g "set /controls/flight/aileron "
+ * N.B. not null terminated, use get_set_prefix_len
+**/
+constexpr const char* get_set_prefix(fgfs_prop p)
+{
+   return fgfs_property_detail::properties[static_cast<size_t>(p)].set_prefix;
+}
+
+constexpr size_t get_set_prefix_len(fgfs_prop p)
+{
+   return fgfs_property_detail::properties[static_cast<size_t>(p)].set_prefix_len;
+}
+
+/**
+ * @brief the property a flight dimension controls
+ * @return NumProps if there isnt one
+**/
+constexpr fgfs_prop get_control_property(FlightDimension d)
+{
+   switch(d){
+      case FlightDimension::Roll:
+         return fgfs_prop::Aileron;
+      case FlightDimension::Pitch:
+         return fgfs_prop::Elevator;
+      case FlightDimension::Yaw:
+         return fgfs_prop::Rudder;
+      case FlightDimension::Throttle:
+         return fgfs_prop::Throttle;
+      case FlightDimension::Flap:
+         return fgfs_prop::Flaps;
+      case FlightDimension::Spoiler:
+         return fgfs_prop::Spoilers;
+      default:
+         return fgfs_prop::NumProps;
+   }
+}
+
+#endif // FG_EXT_FGFS_PROPERTY_HPP_INCLUDED
@@ -0,0 +1,72 @@
+#ifndef FG_EXT_FGFS_PROPERTY_MIRROR_HPP_INCLUDED
+#define FG_EXT_FGFS_PROPERTY_MIRROR_HPP_INCLUDED
+
+#include <cstdint>
+#include <fgfs_telnet.hpp>
+
+/**
+ * @brief keep local copies of FlightGear properties up to date using the telnet "subscribe" command.
+ * FlightGear pushes a "path=value" line whenever a subscribed property changes. Those lines are
+ * parsed as they arrive into the typed destinations, so the control loop reads the properties
+ * from memory with no round trips.
+ * N.B. once subscribed, replies to fgfs_telnet::get would be mixed with the pushed lines,
+ * so read other properties on another connection
+**/
+struct fgfs_property_mirror{
+
+   static constexpr uint32_t max_properties = fgfs_telnet_get_batch::max_gets;
+   static constexpr uint32_t max_path_len = 128;
+
+   explicit fgfs_property_mirror(fgfs_telnet & telnet)
+   : m_telnet{telnet}, m_num_updates{0}, m_num_unknown{0}, m_subscribed{false}{}
+
+   /**
+    * @brief add a property to mirror into dest. Call before subscribe
+    * @return false if full or the path is too long
+    **/
+   bool add(const char* path, double & dest) { return add_path(path) && m_batch.add(path,dest);}
+   bool add(const char* path, float & dest) { return add_path(path) && m_batch.add(path,dest);}
+   bool add(const char* path, int32_t & dest) { return add_path(path) && m_batch.add(path,dest);}
+   template <typename T>
+   bool add(fgfs_prop prop, T & dest) { return add(get_path(prop),dest);}
+
+   /**
+    * @brief read the initial values of all the properties in one round trip then subscribe to changes
+    * @return false if any initial value couldnt be read or the subscribe commands couldnt be sent.
+    * If they couldnt be sent, subscribe can be called again
+    **/
+   bool subscribe();
+
+   /**
+    * @brief parse any pushed values that have arrived, without blocking. Call when the telnet socket is readable
+    * Lines that arent for a mirrored property are discarded
+    * @return false if FlightGear closed the connection
+    **/
+   bool process_input();
+
+   /// @brief number of pushed values applied to the mirror
+   uint64_t get_num_updates() const { return m_num_updates;}
+   /// @brief number of lines received that werent a value for a mirrored property
+   uint64_t get_num_unknown() const { return m_num_unknown;}
+
+   /**
+    * @brief copy path to dest without any [0] indices, which FlightGear leaves out of pushed paths
+    * e.g "/sim[0]/frame-rate" becomes "/sim/frame-rate"
+    * @return false if dest is too small
+    **/
+   static bool normalise_path(const char* path, char* dest, uint32_t dest_len);
+
+private:
+   bool add_path(const char* path);
+   bool process_line(const char* line);
+
+   fgfs_telnet & m_telnet;
+   fgfs_telnet_get_batch m_batch;
+   /// @brief normalised paths, in the same order as the batch
+   char m_paths[max_properties][max_path_len];
+   uint64_t m_num_updates;
+   uint64_t m_num_unknown;
+   bool m_subscribed;
+};
+
+#endif // FG_EXT_FGFS_PROPERTY_MIRROR_HPP_INCLUDED
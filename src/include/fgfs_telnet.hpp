@@ -1,7 +1,10 @@
 #ifndef FG_EXTERNAL_TEST_FGFS_CLIENT_HPP_INCLUDED
 #define FG_EXTERNAL_TEST_FGFS_CLIENT_HPP_INCLUDED
 
+#include <cstdint>
+#include <cstddef>
 #include <quan/time.hpp>
+#include <fgfs_property.hpp>
 
 /*
  Copyright (C) Andy Little 2021
@@ -22,6 +25,53 @@
  along with this program. If not, see http://www.gnu.org/licenses./
 */
 
+/**
+ * @brief a list of properties to read from FlightGear in one round trip
+ * with fgfs_telnet::get(batch). The destinations must outlive the batch
+**/
+struct fgfs_telnet_get_batch{
+
+   static constexpr uint32_t max_gets = 32;
+
+   /**
+    * @brief add a property to read into dest
+    * @return false if the batch is full
+    **/
+   bool add(const char* prop, double & dest) { return add(prop,&dest,dest_type::Double);}
+   bool add(const char* prop, float & dest) { return add(prop,&dest,dest_type::Float);}
+   bool add(const char* prop, int32_t & dest) { return add(prop,&dest,dest_type::Int32);}
+   template <typename T>
+   bool add(fgfs_prop prop, T & dest) { return add(get_path(prop),dest);}
+
+   void clear() { m_size = 0;}
+   uint32_t size() const { return m_size;}
+   const char* get_prop(uint32_t i) const { return m_entries[i].prop;}
+   /**
+    * @brief parse a property value as text into the destination of entry i
+    * @return false if the text isnt a number
+    **/
+   bool set_value(uint32_t i, const char* text) const;
+
+   enum class dest_type : uint8_t { Double, Float, Int32 };
+private:
+   friend class fgfs_telnet;
+   struct entry{
+      const char* prop;
+      void* dest;
+      dest_type type;
+   };
+   bool add(const char* prop, void* dest, dest_type type)
+   {
+      if ( m_size == max_gets){
+         return false;
+      }
+      m_entries[m_size++] = {prop,dest,type};
+      return true;
+   }
+   entry m_entries[max_gets];
+   uint32_t m_size = 0;
+};
+
 class fgfs_telnet {
 public:
 
@@ -40,21 +90,66 @@ public:
    template <typename T>
    bool get(const char* prop, T& val);
 
+   /**
+    * @brief read all the properties in the batch with one write and one round trip.
+    * The replies are parsed in order into the batch destinations
+    * @return false if any property couldnt be read. Its destination is unchanged
+    **/
+   bool get(fgfs_telnet_get_batch const & batch);
+
    template <typename T>
    bool set(const char* prop, T const & val) const;
 
+   template <typename T>
+   bool get(fgfs_prop prop, T& val) { return get(get_path(prop),val);}
+
+   /**
+    * @brief set a registered property. The command prefix is prerendered, so only the value is formatted
+    **/
+   bool set(fgfs_prop prop, double val) const;
+
 	bool write(const char *msg, ...)const;
 /**
-  @return pointer to internal buffer with result or null
+  @brief write preformatted commands, each ending in CR LF, with as few write syscalls as possible
+  @return true when all len bytes are written
+*/
+   bool write_all(const char* buf, size_t len) const;
+/**
+  @return pointer to internal buffer with the next line of the result or null
 */
 	const char* read();
+/**
+  @brief read the next complete line, buffering any partial line or following lines 
+   that arrived in the same read
+  @return pointer to the line in the internal buffer, without its line end.
+  valid until the next read. null if FlightGear closed the connection
+*/
+   const char* read_line();
+/**
+  @brief as read_line, but only reads what has already arrived
+  @param line set to the next complete line, or null if there isnt one yet
+  @return false if FlightGear closed the connection
+*/
+   bool read_line_nonblocking(const char* & line);
 	void flush();
+/**
+  @brief discard any input without blocking. 
+  @return false if FlightGear closed the connection
+*/
+   bool drain_input();
+   /// @brief the socket file descriptor, e.g for an event_loop
+   int get_fd() const { return m_sock;}
 	void settimeout(quan::time_<int32_t>::s t) { m_timeout = t; }
 	int  close();
 private:
+   char* take_buffered_line();
 	int		m_sock;
 	char *	m_buffer;
    size_t   m_buflen;
+   /// @brief start of the next unread line in m_buffer
+   size_t   m_line_start;
+   /// @brief number of bytes received into m_buffer
+   size_t   m_buffer_used;
 	quan::time_<int32_t>::s	m_timeout;
 	bool		m_connected;
 };
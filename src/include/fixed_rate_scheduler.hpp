@@ -0,0 +1,66 @@
+#ifndef FG_EXT_FIXED_RATE_SCHEDULER_HPP_INCLUDED
+#define FG_EXT_FIXED_RATE_SCHEDULER_HPP_INCLUDED
+
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <quan/time.hpp>
+#include <latency_histogram.hpp>
+
+/**
+ * @brief run a loop at a fixed period without drift.
+ * Deadlines are absolute times on CLOCK_MONOTONIC, each exactly one period after the last,
+ * so time spent in the loop body and late wakeups dont accumulate.
+ * If the loop overruns by more than a whole period the missed deadlines are skipped 
+ * rather than run back to back, and counted.
+ * Records wakeup jitter ( time woken after the deadline) and, for overruns, how late 
+ * the loop was when it got back to wait.
+**/
+struct fixed_rate_scheduler{
+
+   fixed_rate_scheduler(const char* name, quan::time::us const & period);
+
+   /**
+    * @brief set the first deadline one period from now
+    **/
+   void start();
+
+   /**
+    * @brief sleep until the next deadline with clock_nanosleep(TIMER_ABSTIME)
+    * then advance the deadline by one period. Doesnt sleep if the deadline has passed
+    * @return number of periods since the last wait, 1 unless deadlines were missed
+    **/
+   uint64_t wait();
+
+   /**
+    * @brief for timers driven by something else e.g an event_loop timerfd set to get_next_deadline()
+    * call when the timer expires to record the statistics and advance the deadline
+    * @param expirations number of periods expired since the last call
+    **/
+   void on_expired(uint64_t expirations);
+
+   /// @brief next deadline as CLOCK_MONOTONIC time
+   timespec get_next_deadline() const;
+   int64_t get_period_ns() const { return m_period_ns;}
+
+   /// @brief number of deadlines the loop was late for
+   uint64_t get_num_overruns() const { return m_num_overruns;}
+   /// @brief number of whole periods skipped after overruns
+   uint64_t get_num_missed_periods() const { return m_num_missed_periods;}
+
+   latency_histogram const & get_jitter() const { return m_jitter;}
+   latency_histogram const & get_overrun() const { return m_overrun;}
+
+   void dump(FILE* f) const;
+
+private:
+   const char* m_name;
+   int64_t m_period_ns;
+   int64_t m_next_deadline_ns;
+   uint64_t m_num_overruns;
+   uint64_t m_num_missed_periods;
+   latency_histogram m_jitter;
+   latency_histogram m_overrun;
+};
+
+#endif // FG_EXT_FIXED_RATE_SCHEDULER_HPP_INCLUDED
@@ -2,13 +2,16 @@
 #define FG_EXTERNAL_FLIGHT_CONTROLLER_HPP_INCLUDED
 
 #include <control_dimension.hpp>
-#include "fgfs_telnet.hpp"
+#include <control_sink.hpp>
+#include <control_sender.hpp>
 #include <autoconv_net_fdm.hpp>
+#include <fdm_state.hpp>
+#include <latency_histogram.hpp>
 #include <quan/time.hpp>
 
 struct abc_flight_controller{
 
-   using float_type = quan::quantity_traits::default_value_type;
+   using float_type = control_float_type;
 
    virtual float_type get_roll() const = 0;
    virtual float_type get_pitch() const  = 0;
@@ -17,44 +20,38 @@ struct abc_flight_controller{
    virtual float_type get_spoiler() const = 0;
    virtual float_type get_flap() const  = 0;
 
-   virtual bool pre_update(autoconv_FGNetFDM const & fdm, quan::time::ms const & time_step) { return true;}
+   virtual bool pre_update(fdm_state const & fdm, quan::time::ms const & time_step) { return true;}
 
+   /**
+    * @brief decode the fdm packet once then update
+    **/
    bool update(autoconv_FGNetFDM const & fdm, quan::time::ms const & time_step)
    {
-      try {
-         bool result = pre_update(fdm,time_step);
-         return 
-            result &&
-            set_control("/controls/flight/aileron",this->get_roll(),
-               m_flight_controls_cache[static_cast<int>(FlightDimension::Roll)]) &&
-            set_control("/controls/flight/elevator",this->get_pitch(),
-               m_flight_controls_cache[static_cast<int>(FlightDimension::Pitch)]) &&
-            set_control("/controls/flight/rudder",this->get_yaw(),
-               m_flight_controls_cache[static_cast<int>(FlightDimension::Yaw)]) &&
-            set_control("/controls/engines/engine[0]/throttle",this->get_throttle(),
-               m_flight_controls_cache[static_cast<int>(FlightDimension::Throttle)]);
-      }catch(...){
-         fprintf(stderr,"set controls failed\n");
-         return false;
-      }
-   };
+      int64_t const t0 = get_time_ns(CLOCK_MONOTONIC);
+      decode_fdm(fdm,m_fdm_state);
+      record_latency(latency_stage::Decode, get_time_ns(CLOCK_MONOTONIC) - t0);
+      return update(m_fdm_state,time_step);
+   }
+
+   bool update(fdm_state const & fdm, quan::time::ms const & time_step)
+   {
+      return m_sender.update(
+         [&]{ return pre_update(fdm,time_step);},
+         [this]{ return m_sender.send_controls(get_roll(),get_pitch(),get_yaw(),get_throttle());}
+      );
+   }
+
+   /**
+    * @brief record the control values output by each update. nullptr to stop recording
+    **/
+   void set_recorder(flight_recorder* recorder) { m_sender.set_recorder(recorder);}
 
 protected:
-   abc_flight_controller(fgfs_telnet const & t)
-   : m_telnet(t){}
+   abc_flight_controller(abc_control_sink & sink)
+   : m_sender{sink}{}
 private:
-   /// @brief only set a property if its value changed
-   bool set_control ( const char * prop, float_type const & latest, float_type& cached)
-   {
-      if ( latest == cached){
-         return true;
-      }else{
-         cached = latest;
-         return m_telnet.set(prop,latest);
-      }
-   };
-   fgfs_telnet const & m_telnet;
-   float_type m_flight_controls_cache[8] = {0.0};
+   control_sender<abc_control_sink> m_sender;
+   fdm_state m_fdm_state;
 };
 
 #endif // FG_EXTERNAL_FLIGHT_CONTROLLER_HPP_INCLUDED
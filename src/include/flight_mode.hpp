@@ -1,12 +1,32 @@
 #ifndef FG_EXT_FLIGHT_MODE_HPP_INCLUDED
 #define FG_EXT_FLIGHT_MODE_HPP_INCLUDED
 
+#include <cstdint>
 
    enum class flight_mode : uint8_t {
       Manual,
       StraightnLevel
    };
 
+   /**
+    * @brief put the terminal into raw mode, once.
+    * The original mode is restored at exit, or on SIGINT or SIGTERM.
+    * stdin is left blocking, since its flags are shared with stdout, stderr and child processes
+    * @return the keyboard fd to wait on e.g with event_loop::add_fd
+    **/
+   int init_keyboard();
+
+   /**
+    * @brief read all pending key presses and switch flight mode.
+    * Call when the keyboard fd is readable. stdin is non-blocking only during the call
+    * 'a' selects StraightnLevel, space selects Manual
+    * @return false at end of input, when the fd should no longer be waited on
+    **/
+   bool process_keyboard_input();
+
+   /**
+    * @brief the current flight mode. No syscalls, so can be called every frame
+    **/
    flight_mode get_flight_mode();
 
 #endif // FG_EXT_FLIGHT_MODE_HPP_INCLUDED
@@ -0,0 +1,135 @@
+#ifndef FG_EXT_FLIGHT_RECORDER_HPP_INCLUDED
+#define FG_EXT_FLIGHT_RECORDER_HPP_INCLUDED
+
+#include <cstdint>
+#include <cstddef>
+#include <ctime>
+#include <net_fdm.hxx>
+#include <autoconv_net_fdm.hpp>
+
+/**
+ * @file binary flight recorder.
+ * fdm frames and control outputs are appended to two fixed size rings in a preallocated, memory mapped file.
+ * The file is mapped shared, so every record is in the page cache as soon as it is written
+ * and the log stays readable if the process crashes.
+ * When a ring is full the oldest records are overwritten.
+**/
+
+namespace flight_log{
+
+   static constexpr char magic[8] = {'F','G','E','X','T','L','O','G'};
+   static constexpr uint32_t version = 1;
+
+   /**
+    * @brief fdm frame exactly as received from FlightGear ( network byte order)
+    **/
+   struct fdm_record{
+      uint64_t seq;          // 1 based sequence number, 0 while being written
+      int64_t time_ns;       // CLOCK_REALTIME arrival time
+      FGNetFDM fdm;          // raw network byte order bytes, read back via autoconv_FGNetFDM
+   };
+
+   /**
+    * @brief control values output by abc_flight_controller::update
+    **/
+   struct control_record{
+      uint64_t seq;          // 1 based sequence number, 0 while being written
+      int64_t time_ns;       // CLOCK_REALTIME
+      float aileron;
+      float elevator;
+      float rudder;
+      float throttle;
+   };
+
+   struct file_header{
+      char magic[8];
+      uint32_t version;
+      uint32_t header_size;
+      uint32_t fdm_record_size;
+      uint32_t control_record_size;
+      uint64_t fdm_capacity;
+      uint64_t control_capacity;
+      uint64_t fdm_offset;
+      uint64_t control_offset;
+      uint64_t fdm_next_seq;      // updated after each record
+      uint64_t control_next_seq;
+   };
+}
+
+struct flight_recorder{
+
+   /**
+    * @brief create or overwrite the log file at path and preallocate space for the given number of records
+    * e.g 4 hours of fdm at 50 Hz is 720000 records
+    **/
+   flight_recorder(const char* path, uint64_t fdm_capacity, uint64_t control_capacity);
+   ~flight_recorder();
+   flight_recorder(flight_recorder const &) = delete;
+   flight_recorder& operator =(flight_recorder const &) = delete;
+
+   /**
+    * @brief append a received fdm frame. No syscalls or allocation
+    * @param arrival_time as from fgfs_fdm_in::get_arrival_time
+    **/
+   void record_fdm(autoconv_FGNetFDM const & fdm, timespec const & arrival_time);
+
+   /**
+    * @brief append the control values sent in a frame. No syscalls or allocation
+    **/
+   void record_controls(float aileron, float elevator, float rudder, float throttle);
+
+   /**
+    * @brief ask the kernel to write the log to disk now. Not needed for crash safety, only power loss
+    **/
+   void sync();
+
+private:
+   flight_log::file_header & header() { return *reinterpret_cast<flight_log::file_header*>(m_map);}
+
+   int m_fd;
+   uint8_t* m_map;
+   size_t m_map_size;
+   flight_log::fdm_record* m_fdm_records;
+   flight_log::control_record* m_control_records;
+   uint64_t m_fdm_capacity;
+   uint64_t m_control_capacity;
+   uint64_t m_fdm_next_seq;
+   uint64_t m_control_next_seq;
+};
+
+/**
+ * @brief read back a log written by flight_recorder, including after a crash
+ * Records that were being written at the time of a crash are skipped
+**/
+struct flight_log_reader{
+
+   explicit flight_log_reader(const char* path);
+   ~flight_log_reader();
+   flight_log_reader(flight_log_reader const &) = delete;
+   flight_log_reader& operator =(flight_log_reader const &) = delete;
+
+   /// @brief oldest fdm record still in the log
+   uint64_t get_first_fdm_seq() const { return m_first_fdm_seq;}
+   /// @brief newest fdm record, 0 if none
+   uint64_t get_last_fdm_seq() const { return m_last_fdm_seq;}
+   /// @return the record or nullptr if it was overwritten or incomplete
+   flight_log::fdm_record const * get_fdm_record(uint64_t seq) const;
+
+   uint64_t get_first_control_seq() const { return m_first_control_seq;}
+   uint64_t get_last_control_seq() const { return m_last_control_seq;}
+   flight_log::control_record const * get_control_record(uint64_t seq) const;
+
+private:
+   uint8_t const* m_map;
+   size_t m_map_size;
+   flight_log::fdm_record const* m_fdm_records;
+   flight_log::control_record const* m_control_records;
+   uint64_t m_fdm_capacity;
+   uint64_t m_control_capacity;
+   uint64_t m_first_fdm_seq;
+   uint64_t m_last_fdm_seq;
+   uint64_t m_first_control_seq;
+   uint64_t m_last_control_seq;
+};
+
+#endif // FG_EXT_FLIGHT_RECORDER_HPP_INCLUDED
@@ -0,0 +1,31 @@
+#ifndef FG_EXT_FLIGHT_REPLAY_HPP_INCLUDED
+#define FG_EXT_FLIGHT_REPLAY_HPP_INCLUDED
+
+#include <cstdint>
+#include <functional>
+#include <flight_recorder.hpp>
+#include <flight_controller.hpp>
+
+struct flight_replay_stats{
+   uint64_t num_frames = 0;      // frames fed to the controller
+   uint64_t num_missing = 0;     // overwritten or incomplete records skipped
+   int64_t flight_time_ns = 0;   // recorded time from first to last frame replayed
+   int64_t replay_time_ns = 0;   // time taken to replay
+   bool completed = false;       // false if the controller update failed
+};
+
+/**
+ * @brief feed every fdm frame in a flight log to a flight controller, as fast as possible.
+ * The time step for each frame is the difference between the recorded arrival times,
+ * so the controller sees the same inputs as it did in flight.
+ * @param default_time_step used for the first frame and if the recorded times go backwards
+ * @param on_frame if set, called with each record before the controller is updated e.g to timestamp a trace
+**/
+flight_replay_stats replay_flight_log(
+   flight_log_reader const & log,
+   abc_flight_controller & fc,
+   quan::time::ms const & default_time_step,
+   std::function<void(flight_log::fdm_record const &)> const & on_frame = {}
+);
+
+#endif // FG_EXT_FLIGHT_REPLAY_HPP_INCLUDED
@@ -0,0 +1,48 @@
+#ifndef FG_EXT_FORMAT_FIXED_HPP_INCLUDED
+#define FG_EXT_FORMAT_FIXED_HPP_INCLUDED
+
+#include <cstdio>
+#include <cstdint>
+#include <cmath>
+#include <charconv>
+
+namespace fgfs_format_detail{
+   /// @brief decimal places, as "%f"
+   constexpr int decimal_places = 6;
+   constexpr int64_t decimal_scale = 1000000;
+}
+
+/**
+ * @brief write v in fixed point with 6 decimal places like "%f", using integer to_chars
+ * ( gcc 9 has no floating point to_chars)
+ * @return end of the written chars or nullptr if there wasnt room
+**/
+inline char* format_fixed(char* first, char* last, double v)
+{
+   using namespace fgfs_format_detail;
+   if ( !std::isfinite(v) || (std::fabs(v) >= 1.e12) ){
+      int const n = ::snprintf(first, last - first, "%f", v);
+      return ( (n > 0) && (n < (last - first)) ) ? first + n : nullptr;
+   }
+   int64_t const scaled = std::llround(std::fabs(v) * decimal_scale);
+   if ( (scaled != 0) && (v < 0.0) ){
+      if ( first == last){
+         return nullptr;
+      }
+      *first++ = '-';
+   }
+   auto const int_result = std::to_chars(first, last, scaled / decimal_scale);
+   if ( (int_result.ec != std::errc{}) || ((last - int_result.ptr) < (decimal_places + 1)) ){
+      return nullptr;
+   }
+   char* p = int_result.ptr;
+   *p++ = '.';
+   int64_t frac = scaled % decimal_scale;
+   for ( int i = decimal_places - 1; i >= 0; --i){
+      p[i] = static_cast<char>('0' + frac % 10);
+      frac /= 10;
+   }
+   return p + decimal_places;
+}
+
+#endif // FG_EXT_FORMAT_FIXED_HPP_INCLUDED
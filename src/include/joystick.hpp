@@ -4,6 +4,8 @@
 #include <autoconv_net_fdm.hpp>
 #include <control_source_concept.hpp>
 #include <joystick_dimension.hpp>
+#include <joystick_reader.hpp>
+#include <latency_histogram.hpp>
 /**
   model of Ccontrol_source
 **/
@@ -20,18 +22,48 @@ namespace detail{
 struct joystick_t{
 
   joystick_t( const char * path)
-  : m_js{path}
+  : m_reader{path}
+  , m_js{}
+  , m_snapshot_count{0}
   , roll{m_js}
   , pitch{m_js}
   , yaw{m_js}
   , throttle{m_js}
   , flap{m_js}
   , spoiler{m_js}
-  {}
+  {
+     m_reader.start();
+  }
 
+  /**
+   * @brief take the latest snapshot of all axes from the reader thread.
+   * Call once per frame, before reading the dimensions
+  **/
+  void update()
+  {
+     uint32_t const count = m_reader.get_state(m_js);
+     if ( count != m_snapshot_count){
+        m_snapshot_count = count;
+        record_latency(latency_stage::JoystickInput, get_time_ns(CLOCK_MONOTONIC) - m_js.time_ns);
+     }
+  }
+
+  joystick_state const & get_state() const { return m_js;}
+
+  /**
+   * @brief value of dimension D from the latest snapshot, constrained as control_dimension::get.
+   * Non virtual, for control_pipeline
+  **/
+  template <FlightDimension D>
+  control_float_type get() const
+  {
+     return constrain_control_value<D>(get_joystick_axis_value<D>(m_js));
+  }
    
 private:
-   quan::joystick m_js;
+   joystick_reader m_reader;
+   joystick_state m_js;
+   uint32_t m_snapshot_count;
 public:
    joystick_dimension<FlightDimension::Roll> const roll;
    joystick_dimension<FlightDimension::Pitch> const pitch;
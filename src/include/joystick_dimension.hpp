@@ -2,19 +2,91 @@
 #define FG_EXT_JOYSTICK_CONTROL_SOURCE_HPP_INCLUDED
 
 #include <control_dimension.hpp>
-#include <quan/joystick.hpp>
-#include <quan/quantity_traits.hpp>
+#include <joystick_reader.hpp>
+#include <numeric_policy.hpp>
 
+namespace joystick_mapping{
+
+  /**
+   * @brief range of raw Taranis joystick input is nominally +- 32767
+   **/
+   static constexpr double joystick_half_range = 32767.0;
+   
+   /**
+    * @brief channel numbers of joystick channels
+   **/
+   static constexpr uint8_t roll_idx = 0;  // roll on ch 0
+   static constexpr uint8_t pitch_idx = 1; // pitch on ch 1
+   static constexpr uint8_t throttle_idx = 2;
+   static constexpr uint8_t yaw_idx = 3;   // yaw on ch 3
+   static constexpr uint8_t flap_idx = 4;
+   static constexpr uint8_t spoiler_idx = 5;
+   static constexpr uint8_t flight_mode = 7; 
+
+   /**
+    * @brief joystick channel direction of raw joystick input, 
+    * either 1 or -1 dependent on joystick setup
+   **/
+   static constexpr int32_t js_sign []= {
+      1,   // roll
+      1,   // pitch
+      1,   // throttle
+      -1,   // yaw
+      1,   // flap
+      1,    // spoiler
+      1,   //
+      1,   // mode
+   };
+
+   template <FlightDimension D>
+   constexpr int16_t get_joystick_channel_idx = -1;
+
+   template <>
+   constexpr int16_t get_joystick_channel_idx<FlightDimension::Roll> = roll_idx;
+
+   template <>
+   constexpr int16_t get_joystick_channel_idx<FlightDimension::Pitch> = pitch_idx;
+
+   template <>
+   constexpr int16_t get_joystick_channel_idx<FlightDimension::Yaw> = yaw_idx;
+
+   template <>
+   constexpr int16_t get_joystick_channel_idx<FlightDimension::Throttle> = throttle_idx;
+
+   template <>
+   constexpr int16_t get_joystick_channel_idx<FlightDimension::Flap> = flap_idx;
+
+   template <>
+   constexpr int16_t get_joystick_channel_idx<FlightDimension::Spoiler> = spoiler_idx;
+}
+
+/**
+ * @brief value of dimension D mapped from its axis in a joystick snapshot, not yet constrained.
+ * Inline, so static control sources can read the joystick with no virtual call
+**/
+template <FlightDimension D>
+inline control_float_type get_joystick_axis_value(joystick_state const & js)
+{
+   int constexpr i = joystick_mapping::get_joystick_channel_idx<D>;
+   static_assert(i >= 0,"no joystick channel for this dimension");
+   control_float_type const v = (js.axes[i] * joystick_mapping::js_sign[i]) / joystick_mapping::joystick_half_range;
+   return(flight_dimension_is_signed<D>) ? v : ((v + 1.0) / 2.0) ;
+}
+
+/**
+ * @brief a control dimension mapped from a joystick axis.
+ * Reads the axis from a snapshot so all dimensions in a frame come from the same joystick state
+**/
 template <FlightDimension D>
 struct joystick_dimension final : control_dimension<D>
 {
-   joystick_dimension(quan::joystick const & js);
+   joystick_dimension(joystick_state const & js);
 
-   using float_type = quan::quantity_traits::default_value_type;
+   using float_type = control_float_type;
    float_type get_impl() const final;
 
    private:
-     quan::joystick const & m_joystick;
+     joystick_state const & m_joystick;
 };
 
 #endif // FG_EXT_JOYSTICK_CONTROL_SOURCE_HPP_INCLUDED
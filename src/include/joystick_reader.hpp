@@ -0,0 +1,71 @@
+#ifndef FG_EXT_JOYSTICK_READER_HPP_INCLUDED
+#define FG_EXT_JOYSTICK_READER_HPP_INCLUDED
+
+#include <atomic>
+#include <thread>
+#include <cstdint>
+#include <seqlock.hpp>
+
+/**
+ * @brief all joystick axes at one instant
+**/
+struct joystick_state{
+   static constexpr uint32_t max_axes = 8;
+   /// @brief raw axis values, nominally +- 32767
+   int16_t axes[max_axes];
+   /// @brief CLOCK_MONOTONIC time the latest event in the snapshot was read, 0 if none yet
+   int64_t time_ns;
+   /// @brief driver timestamp of the latest event in ms
+   uint32_t event_time_ms;
+   /// @brief total number of axis events read
+   uint32_t num_events;
+};
+
+/**
+ * @brief read joystick events from a linux joystick device e.g /dev/input/js0 on a dedicated thread.
+ * All the events available at once are applied, then the complete set of axes is published,
+ * timestamped, through a seqlock, so a reader always gets every axis from the same instant
+ * and can see how old the input is.
+**/
+struct joystick_reader{
+
+   /**
+    * @brief open the device. throws if it cant be opened
+    **/
+   explicit joystick_reader(const char* path);
+   ~joystick_reader();
+   joystick_reader(joystick_reader const &) = delete;
+   joystick_reader& operator =(joystick_reader const &) = delete;
+
+   /**
+    * @brief start the read thread
+    **/
+   void start();
+
+   /**
+    * @brief stop the read thread (done automatically in destructor)
+    **/
+   void stop();
+
+   /**
+    * @brief get a consistent copy of the latest axes. Can be called from any thread
+    * @return number of snapshots published so far, 0 if state is just the initial state
+    **/
+   uint32_t get_state(joystick_state & state) const { return m_state.load(state);}
+
+   /**
+    * @brief false if the device failed e.g was unplugged. The last state is still available
+    **/
+   bool is_connected() const { return m_connected.load(std::memory_order_relaxed);}
+
+private:
+   void run();
+
+   int m_fd;
+   seqlock<joystick_state> m_state;
+   std::atomic<bool> m_connected;
+   std::atomic<bool> m_running;
+   std::thread m_thread;
+};
+
+#endif // FG_EXT_JOYSTICK_READER_HPP_INCLUDED
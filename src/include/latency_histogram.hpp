@@ -0,0 +1,138 @@
+#ifndef FG_EXT_LATENCY_HISTOGRAM_HPP_INCLUDED
+#define FG_EXT_LATENCY_HISTOGRAM_HPP_INCLUDED
+
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+
+/**
+ * @brief fixed bucket log-linear (HDR style) histogram of durations in ns
+ * Each power of 2 range is split into 16 linear sub-buckets, so any recorded value is
+ * resolved to within about 6%, from 1 ns up to max_value.
+ * record() does no allocation or syscalls. Record from one thread only.
+**/
+struct latency_histogram{
+
+   static constexpr uint32_t sub_bucket_bits = 4;
+   static constexpr uint32_t sub_bucket_count = 1U << sub_bucket_bits;
+   /// @brief values larger than this are counted in the top bucket ( ~ 18 minutes)
+   static constexpr uint32_t max_value_bits = 40;
+   static constexpr uint64_t max_value = (1ULL << max_value_bits) - 1;
+   static constexpr uint32_t num_buckets = (max_value_bits - sub_bucket_bits + 1) * sub_bucket_count;
+
+   explicit latency_histogram(const char* name);
+
+   void record(int64_t ns)
+   {
+      uint64_t const v = (ns < 0) ? 0 : ((static_cast<uint64_t>(ns) > max_value) ? max_value : ns);
+      ++m_counts[bucket_index(v)];
+      ++m_count;
+      m_sum += v;
+      if ( v < m_min){
+         m_min = v;
+      }
+      if ( v > m_max){
+         m_max = v;
+      }
+   }
+
+   void reset();
+
+   const char* get_name() const { return m_name;}
+   uint64_t get_count() const { return m_count;}
+   uint64_t get_min() const { return (m_count > 0) ? m_min : 0;}
+   uint64_t get_max() const { return m_max;}
+   uint64_t get_mean() const { return (m_count > 0) ? m_sum / m_count : 0;}
+   /**
+    * @param p percentile in range 0 to 100
+    * @return value at percentile p, resolved to bucket midpoint
+    **/
+   uint64_t get_percentile(double p) const;
+
+   /**
+    * @brief write summary and non empty buckets in text form
+    **/
+   void dump(FILE* f) const;
+
+   static uint32_t bucket_index(uint64_t v)
+   {
+      if ( v < sub_bucket_count){
+         return static_cast<uint32_t>(v);
+      }
+      uint32_t const msb = 63U - static_cast<uint32_t>(__builtin_clzll(v));
+      uint32_t const shift = msb - sub_bucket_bits;
+      return (shift + 1) * sub_bucket_count + static_cast<uint32_t>((v >> shift) - sub_bucket_count);
+   }
+
+   /// @brief lowest value counted in bucket idx
+   static uint64_t bucket_lowest_value(uint32_t idx);
+   /// @brief width of bucket idx in ns
+   static uint64_t bucket_width(uint32_t idx);
+
+private:
+   const char* m_name;
+   uint64_t m_count;
+   uint64_t m_sum;
+   uint64_t m_min;
+   uint64_t m_max;
+   uint64_t m_counts[num_buckets];
+};
+
+/**
+ * @brief stages of the fdm to actuation path
+**/
+enum class latency_stage : uint8_t {
+   Arrival,     // kernel receive timestamp to fdm available in user space
+   Decode,      // fdm packet to host order fdm_state
+   PreUpdate,   // abc_flight_controller::pre_update
+   SetControl,  // sending changed controls to FlightGear
+   EndToEnd,    // kernel receive timestamp to controls sent
+   JoystickInput, // joystick event read to first use by a controller
+   NumStages
+};
+
+/**
+ * @brief the histogram for a stage of the fdm path
+**/
+latency_histogram & get_latency_histogram(latency_stage stage);
+
+inline void record_latency(latency_stage stage, int64_t ns)
+{
+   get_latency_histogram(stage).record(ns);
+}
+
+/**
+ * @brief write all the stage histograms
+**/
+void dump_latency_histograms(FILE* f);
+
+/**
+ * @brief request a dump of the stage histograms when signal sig is received
+ * The dump is done by the next call to service_latency_dump_request, not in the signal handler
+**/
+void dump_latency_histograms_on_signal(int sig);
+
+/**
+ * @brief call from the control loop. dumps the stage histograms if a signal was received
+**/
+void service_latency_dump_request(FILE* f);
+
+/**
+ * @brief for loops with their own statistics to dump
+ * @return true, once, if a dump signal was received since the last call
+**/
+bool take_latency_dump_request();
+
+inline int64_t get_time_ns(clockid_t clock)
+{
+   timespec ts;
+   ::clock_gettime(clock,&ts);
+   return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+inline int64_t to_ns(timespec const & ts)
+{
+   return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+#endif // FG_EXT_LATENCY_HISTOGRAM_HPP_INCLUDED
@@ -6,10 +6,17 @@
 
 struct manual_flight_controller final : abc_flight_controller{
 
-   manual_flight_controller(fgfs_telnet const & t,const char * joystick_path)
-   : abc_flight_controller{t}, m_joystick{joystick_path}
+   manual_flight_controller(abc_control_sink & sink,const char * joystick_path)
+   : abc_flight_controller{sink}, m_joystick{joystick_path}
    {}
 
+   /// @brief all the controls in a frame come from one joystick snapshot
+   bool pre_update(fdm_state const & fdm, quan::time::ms const & time_step) override
+   {
+      m_joystick.update();
+      return true;
+   }
+
    float_type get_roll() const override{ return m_joystick.roll.get();}
    float_type get_pitch() const override{ return m_joystick.pitch.get();}
    float_type get_yaw() const override{ return m_joystick.yaw.get();}
@@ -0,0 +1,194 @@
+#ifndef FG_EXT_NUMERIC_POLICY_HPP_INCLUDED
+#define FG_EXT_NUMERIC_POLICY_HPP_INCLUDED
+
+#include <cstdint>
+#include <cmath>
+#include <quan/quantity_traits.hpp>
+
+/**
+ * @file numeric types for the control path.
+ * Controller kernels written as templates over a value type T use only T arithmetic, T(double) for constants
+ * and the functions in namespace numeric, so they can be instantiated for float, double or fixed_q16.
+ * float for single precision FPU targets, fixed_q16 for targets with no FPU at all.
+ * The worst case errors of the numeric functions against double libm, over -pi to pi
+ * ( atan2 over the whole circle), as measured for each type:
+ *
+ *   type      sin, cos   poly_sin    poly_atan2   sqrt
+ *   double    libm       6.3e-7      1.2e-5       libm
+ *   float     libm       7.9e-7 *    1.2e-5       libm
+ *   fixed_q16 1.2e-4     1.2e-4      5.9e-5       1.5e-5
+ *
+ * * 1.7e-6 once arguments outside -pi to pi need range reduction.
+ * fixed_q16 sin and cos are poly_sin, whose error is dominated by its coefficients rounded to Q16.16.
+ * Kernels should allow for these when comparing the types, e.g sl_bench compares sl_law<T> against double
+**/
+
+/**
+ * @brief value type of control values through control_dimension, the control sinks and abc_flight_controller.
+ * quan default value type ( double), or float if FG_EXT_CONTROL_FLOAT is defined
+**/
+#if defined FG_EXT_CONTROL_FLOAT
+using control_float_type = float;
+#else
+using control_float_type = quan::quantity_traits::default_value_type;
+#endif
+
+/**
+ * @brief signed Q16.16 fixed point. Range +-32768, resolution 1.5e-5.
+ * Products and quotients use a 64 bit intermediate and are rounded to nearest. There is no saturation,
+ * so kernels must keep values in range ( control law values are all well inside +- 100)
+**/
+struct fixed_q16{
+
+   static constexpr int32_t one = 1 << 16;
+
+   constexpr fixed_q16() : m_raw{0}{}
+   constexpr explicit fixed_q16(double v)
+   : m_raw{static_cast<int32_t>(v * one + ((v < 0.0) ? -0.5 : 0.5))}{}
+
+   static constexpr fixed_q16 from_raw(int32_t raw)
+   {
+      fixed_q16 r;
+      r.m_raw = raw;
+      return r;
+   }
+
+   constexpr int32_t get_raw() const { return m_raw;}
+   constexpr explicit operator double() const { return static_cast<double>(m_raw) / one;}
+   constexpr explicit operator float() const { return static_cast<float>(m_raw) / one;}
+
+   constexpr fixed_q16 operator -() const { return from_raw(-m_raw);}
+
+   friend constexpr fixed_q16 operator +(fixed_q16 a, fixed_q16 b) { return from_raw(a.m_raw + b.m_raw);}
+   friend constexpr fixed_q16 operator -(fixed_q16 a, fixed_q16 b) { return from_raw(a.m_raw - b.m_raw);}
+   friend constexpr fixed_q16 operator *(fixed_q16 a, fixed_q16 b)
+   {
+      return from_raw(static_cast<int32_t>((static_cast<int64_t>(a.m_raw) * b.m_raw + (one / 2)) >> 16));
+   }
+   friend constexpr fixed_q16 operator /(fixed_q16 a, fixed_q16 b)
+   {
+      int64_t const n = static_cast<int64_t>(a.m_raw) * one;
+      int64_t const half = ((n < 0) == (b.m_raw < 0)) ? (b.m_raw / 2) : -(b.m_raw / 2);
+      return from_raw(static_cast<int32_t>((n + half) / b.m_raw));
+   }
+
+   fixed_q16 & operator +=(fixed_q16 b) { return *this = *this + b;}
+   fixed_q16 & operator -=(fixed_q16 b) { return *this = *this - b;}
+   fixed_q16 & operator *=(fixed_q16 b) { return *this = *this * b;}
+   fixed_q16 & operator /=(fixed_q16 b) { return *this = *this / b;}
+
+   friend constexpr bool operator <(fixed_q16 a, fixed_q16 b) { return a.m_raw < b.m_raw;}
+   friend constexpr bool operator >(fixed_q16 a, fixed_q16 b) { return a.m_raw > b.m_raw;}
+   friend constexpr bool operator <=(fixed_q16 a, fixed_q16 b) { return a.m_raw <= b.m_raw;}
+   friend constexpr bool operator >=(fixed_q16 a, fixed_q16 b) { return a.m_raw >= b.m_raw;}
+   friend constexpr bool operator ==(fixed_q16 a, fixed_q16 b) { return a.m_raw == b.m_raw;}
+   friend constexpr bool operator !=(fixed_q16 a, fixed_q16 b) { return a.m_raw != b.m_raw;}
+
+private:
+   int32_t m_raw;
+};
+
+/**
+ * @brief name of each value type, for benchmark output
+**/
+template <typename T> constexpr const char* numeric_type_name = "";
+template <> constexpr const char* numeric_type_name<float> = "float";
+template <> constexpr const char* numeric_type_name<double> = "double";
+template <> constexpr const char* numeric_type_name<fixed_q16> = "Q16.16";
+
+namespace numeric{
+
+   inline float abs(float v) { return std::fabs(v);}
+   inline float sqrt(float v) { return std::sqrt(v);}
+   inline float floor(float v) { return std::floor(v);}
+   inline float sin(float v) { return std::sin(v);}
+   inline float cos(float v) { return std::cos(v);}
+   inline float atan2(float y, float x) { return std::atan2(y,x);}
+
+   inline double abs(double v) { return std::fabs(v);}
+   inline double sqrt(double v) { return std::sqrt(v);}
+   inline double floor(double v) { return std::floor(v);}
+   inline double sin(double v) { return std::sin(v);}
+   inline double cos(double v) { return std::cos(v);}
+   inline double atan2(double y, double x) { return std::atan2(y,x);}
+
+   inline fixed_q16 abs(fixed_q16 v) { return (v.get_raw() < 0) ? -v : v;}
+
+   /// @brief toward -infinity, by clearing the fraction bits
+   inline fixed_q16 floor(fixed_q16 v) { return fixed_q16::from_raw(v.get_raw() & ~(fixed_q16::one - 1));}
+
+   /// @brief bit by bit integer sqrt, rounded down so within one lsb ( 1.5e-5). 0 for negative v
+   inline fixed_q16 sqrt(fixed_q16 v)
+   {
+      if ( v.get_raw() <= 0){
+         return fixed_q16{};
+      }
+      uint64_t n = static_cast<uint64_t>(v.get_raw()) << 16;
+      uint64_t result = 0;
+      uint64_t bit = 1ULL << 62;
+      while ( bit > n){
+         bit >>= 2;
+      }
+      while ( bit != 0){
+         if ( n >= result + bit){
+            n -= result + bit;
+            result = (result >> 1) + bit;
+         }else{
+            result >>= 1;
+         }
+         bit >>= 2;
+      }
+      return fixed_q16::from_raw(static_cast<int32_t>(result));
+   }
+
+   /**
+    * @brief sin from a 7th order minimax polynomial on -pi/2 to pi/2.
+    * Error 6.3e-7 for double, 7.9e-7 for float and 1.2e-4 for fixed_q16, see the table above
+    **/
+   template <typename T>
+   inline T poly_sin(T x)
+   {
+      T const pi(3.14159265358979);
+      T const half_pi(1.57079632679490);
+      T const two_pi(6.28318530717959);
+      // to range -pi to pi, only when needed as the reduction costs precision, then fold to -pi/2 to pi/2
+      x = ((x > pi) || (x < -pi)) ? (x - two_pi * floor((x + pi) / two_pi)) : x;
+      x = (x > half_pi) ? (pi - x) : ((x < -half_pi) ? (-pi - x) : x);
+      T const s = x * x;
+      return x * (T(0.9999966) + s * (T(-0.16664824) + s * (T(0.00830629) + s * T(-0.00018363))));
+   }
+
+   /**
+    * @brief atan2 as fast_atan2. atan2(0,0) is 0.
+    * Error 1.2e-5 for double and float and 5.9e-5 for fixed_q16, see the table above
+    **/
+   template <typename T>
+   inline T poly_atan2(T y, T x)
+   {
+      T const zero(0.0);
+      T const pi(3.14159265358979);
+      T const half_pi(1.57079632679490);
+      T const ax = abs(x);
+      T const ay = abs(y);
+      T const mx = (ax > ay) ? ax : ay;
+      T const mn = (ax > ay) ? ay : ax;
+      T const a = (mx > zero) ? mn / mx : zero;
+      T const s = a * a;
+      T r = a * (T(0.9998660) + s * (T(-0.3302995) + s * (T(0.1801410) + s * (T(-0.0851330) + s * T(0.0208351)))));
+      r = (ay > ax) ? (half_pi - r) : r;
+      r = (x < zero) ? (pi - r) : r;
+      return (y < zero) ? -r : r;
+   }
+
+   inline fixed_q16 sin(fixed_q16 v) { return poly_sin(v);}
+   inline fixed_q16 cos(fixed_q16 v) { return poly_sin(v + fixed_q16{1.57079632679490});}
+   inline fixed_q16 atan2(fixed_q16 y, fixed_q16 x) { return poly_atan2(y,x);}
+
+   template <typename T>
+   inline T constrain(T v, T min, T max)
+   {
+      return (v < min) ? min : ((v > max) ? max : v);
+   }
+}
+
+#endif // FG_EXT_NUMERIC_POLICY_HPP_INCLUDED
@@ -0,0 +1,140 @@
+#ifndef FG_EXT_RIGID_BODY_FDM_HPP_INCLUDED
+#define FG_EXT_RIGID_BODY_FDM_HPP_INCLUDED
+
+#include <cstdint>
+#include <quan/time.hpp>
+#include <autoconv_net_fdm.hpp>
+#include <control_sink.hpp>
+
+/**
+ * @brief constants of rigid_body_fdm. Defaults are for the EasyStar, with the inertia and control torques
+ * of aircraft in examples/straightnlevel.
+ * Axes are body x forward, y right, z down. Stability is given as frequencies and time constants,
+ * so it scales with the inertia
+**/
+struct rigid_body_fdm_params{
+   /// @brief principal moments of inertia about body x, y, z in kg m2
+   double inertia[3] = {0.45 * 0.4 * 0.4, 0.5 * 0.7 * 0.7, 0.1 * 0.1 * 0.1};
+   /// @brief torque in N m at full control deflection, aileron, elevator, rudder
+   double max_control_torque[3] = {0.785398, 0.5 * 0.785398, 0.785398};
+   /// @brief in kg
+   double mass = 1.05;
+   /// @brief in m2
+   double wing_area = 0.24;
+   /// @brief lift coefficient at zero angle of attack, per rad of angle of attack, and at the stall
+   double CL0 = 0.25;
+   double CL_alpha = 5.0;
+   double CL_max = 1.1;
+   /// @brief drag coefficient is CD0 + induced_drag_k * CL * CL
+   double CD0 = 0.03;
+   double induced_drag_k = 0.06;
+   /// @brief side force coefficient per rad of sideslip
+   double CY_beta = -0.3;
+   /// @brief in N at full throttle
+   double max_thrust = 5.0;
+   /**
+    * @brief undamped natural frequency of pitch stability in rad/s, and its damping ratio.
+    * The aircraft trims with the elevator at 0 to the angle of attack for level flight at the start airspeed
+    **/
+   double pitch_frequency = 2.5;
+   double pitch_damping_ratio = 0.7;
+   /// @brief undamped natural frequency of weathercock stability in rad/s, and its damping ratio
+   double yaw_frequency = 2.5;
+   double yaw_damping_ratio = 0.7;
+   /// @brief roll subsidence time constant in s
+   double roll_time_constant = 0.2;
+   /// @brief roll acceleration per rad of sideslip in rad/s2, from dihedral
+   double dihedral_effect = 2.0;
+   /// @brief in kg/m3
+   double air_density = 1.225;
+   /// @brief longest integration step in s. Each update is split into equal steps no longer than this
+   double max_step = 0.002;
+
+   /// @brief start position. latitude and longitude in rad, altitude above sea level in m
+   double latitude = 0.8850;
+   double longitude = -0.0272;
+   double altitude = 1600.0;
+   /// @brief height of the ground above sea level in m
+   double ground_elevation = 600.0;
+   /// @brief start heading in rad and true airspeed in m/s. The aircraft starts level and trimmed
+   double heading = 0.0;
+   double airspeed = 12.0;
+   /// @brief unix time of the first frame
+   uint32_t start_time = 1625000000U;
+};
+
+/**
+ * @brief headless rigid body flight model, to stand in for FlightGear in closed loop tests.
+ * It is a control sink, so a flight controller sends its controls straight to it.
+ * update() integrates the 6 degree of freedom equations of motion over the frame time step,
+ * then fills the FGNetFDM frame the controller reads next.
+ * Aerodynamics are linear lift, parabolic drag and sideslip force, with pitch, yaw and roll stability
+ * and damping, so the model is cheap enough to run thousands of times faster than real time.
+ * Stops at the ground.
+**/
+struct rigid_body_fdm final : abc_control_sink{
+
+   explicit rigid_body_fdm(rigid_body_fdm_params const & params = rigid_body_fdm_params{});
+
+   /**
+    * @brief back to the start position and attitude. The controls keep the values last set, as a real sink would,
+    * since a controller only sends the controls that change ( see control_sender) and would not resend them.
+    * They are 0 until first set
+    **/
+   void reset();
+
+   /**
+    * @brief aileron, elevator and rudder -1 to 1 and throttle 0 to 1 as FlightGear.
+    * Positive aileron rolls right, positive elevator pitches nose down, positive rudder yaws right
+    **/
+   bool set_control(FlightDimension d, float_type const & value) override;
+
+   /**
+    * @brief advance the flight model by time_step, then update the fdm frame
+    **/
+   void update(quan::time::ms const & time_step);
+
+   autoconv_FGNetFDM const & get_fdm() const { return m_fdm;}
+
+   /// @brief simulated time since reset in s
+   double get_time() const { return m_time;}
+   bool is_on_ground() const { return m_on_ground;}
+
+   /// @brief euler angles in rad, x = roll, y = pitch, z = heading 0 to 2 pi
+   void get_euler_angles(double (&euler)[3]) const;
+   /// @brief body rates in rad/s, x = p, y = q, z = r
+   double const (&get_body_rates() const)[3] { return m_rates;}
+   /// @brief in m above sea level
+   double get_altitude() const { return m_altitude;}
+   double get_airspeed() const;
+
+private:
+   void step(double dt);
+   void update_fdm();
+
+   rigid_body_fdm_params const m_params;
+   /// @brief angle of attack in rad the aircraft trims to with the elevator at 0
+   double const m_trim_alpha;
+   /// @brief body to north east down rotation as a unit quaternion w, x, y, z
+   double m_attitude[4];
+   /// @brief body rates in rad/s
+   double m_rates[3];
+   /// @brief north, east, down in m/s
+   double m_velocity[3];
+   /// @brief specific force in body frame in m/s2 from the last step, as felt by the pilot
+   double m_specific_force[3];
+   double m_alpha;
+   double m_beta;
+   double m_latitude;
+   double m_longitude;
+   double m_altitude;
+   double m_time;
+   bool m_on_ground;
+   float_type m_aileron;
+   float_type m_elevator;
+   float_type m_rudder;
+   float_type m_throttle;
+   autoconv_FGNetFDM m_fdm;
+};
+
+#endif // FG_EXT_RIGID_BODY_FDM_HPP_INCLUDED
@@ -0,0 +1,82 @@
+#ifndef FG_EXT_SEQLOCK_HPP_INCLUDED
+#define FG_EXT_SEQLOCK_HPP_INCLUDED
+
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+
+/**
+ * @brief single writer, many reader sequence lock.
+ * The writer never waits for readers and readers never block the writer.
+ * A reader that overlaps a store simply retries, so every successful load is a complete,
+ * consistent snapshot of one stored value.
+ * T must be plain data which can be copied bytewise ( e.g autoconv_FGNetFDM)
+ * The data is held as relaxed atomic words, so there is no data race on a torn read
+**/
+template <typename T>
+struct seqlock{
+
+   seqlock() : m_seq{0}
+   {
+      for ( auto & w : m_data){
+         w.store(0,std::memory_order_relaxed);
+      }
+   }
+
+   seqlock(seqlock const &) = delete;
+   seqlock& operator =(seqlock const &) = delete;
+
+   /**
+    * @brief publish a new value. Only call from one thread
+    **/
+   void store(T const & value)
+   {
+      uint64_t words[num_words] = {0};
+      ::memcpy(words,&value,sizeof(T));
+
+      uint32_t const seq = m_seq.load(std::memory_order_relaxed);
+      m_seq.store(seq + 1,std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      for ( uint32_t i = 0; i < num_words; ++i){
+         m_data[i].store(words[i],std::memory_order_relaxed);
+      }
+      m_seq.store(seq + 2,std::memory_order_release);
+   }
+
+   /**
+    * @brief get a consistent copy of the latest value. Can be called from any thread
+    * @return the number of values stored so far, 0 if value is just the initial state
+    **/
+   uint32_t load(T & value) const
+   {
+      uint64_t words[num_words];
+      for(;;){
+         uint32_t const seq0 = m_seq.load(std::memory_order_acquire);
+         if ( (seq0 & 1U) == 0U){
+            for ( uint32_t i = 0; i < num_words; ++i){
+               words[i] = m_data[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if ( m_seq.load(std::memory_order_relaxed) == seq0){
+               ::memcpy(&value,words,sizeof(T));
+               return seq0 / 2U;
+            }
+         }
+      }
+   }
+
+   /**
+    * @brief number of values stored so far, without reading the value
+    **/
+   uint32_t get_count() const
+   {
+      return m_seq.load(std::memory_order_acquire) / 2U;
+   }
+
+private:
+   static constexpr uint32_t num_words = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+   std::atomic<uint32_t> m_seq;
+   std::atomic<uint64_t> m_data[num_words];
+};
+
+#endif // FG_EXT_SEQLOCK_HPP_INCLUDED
@@ -0,0 +1,30 @@
+#ifndef FG_EXT_TELNET_CONTROL_SINK_HPP_INCLUDED
+#define FG_EXT_TELNET_CONTROL_SINK_HPP_INCLUDED
+
+#include <cstddef>
+#include <control_sink.hpp>
+#include <fgfs_telnet.hpp>
+
+/**
+ * @brief send control values to FlightGear as telnet property sets.
+ * The sets for a frame are collected in one buffer and sent with a single write in end_frame
+**/
+struct telnet_control_sink final : abc_control_sink{
+
+   explicit telnet_control_sink(fgfs_telnet const & t)
+   : m_telnet{t}, m_frame_len{0}{}
+
+   bool begin_frame() override;
+   bool set_control(FlightDimension d, float_type const & value) override;
+   bool end_frame() override;
+
+   /// @brief room for a set of every control, with long property paths
+   static constexpr size_t max_frame_size = 512;
+private:
+   bool flush();
+   fgfs_telnet const & m_telnet;
+   size_t m_frame_len;
+   char m_frame_buffer[max_frame_size];
+};
+
+#endif // FG_EXT_TELNET_CONTROL_SINK_HPP_INCLUDED
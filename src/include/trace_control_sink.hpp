@@ -0,0 +1,39 @@
+#ifndef FG_EXT_TRACE_CONTROL_SINK_HPP_INCLUDED
+#define FG_EXT_TRACE_CONTROL_SINK_HPP_INCLUDED
+
+#include <cstdio>
+#include <control_sink.hpp>
+
+/**
+ * @brief stub sink that writes the controls output each frame as a line of csv
+ * time_s,aileron,elevator,rudder,throttle
+ * Used in place of FlightGear when replaying a recorded flight
+**/
+struct trace_control_sink final : abc_control_sink{
+
+   /**
+    * @param f where to write the trace, or nullptr for no output
+    **/
+   explicit trace_control_sink(FILE* f);
+
+   /**
+    * @brief set the time written with the next frame
+    **/
+   void set_frame_time(double time_s) { m_frame_time = time_s;}
+
+   bool set_control(FlightDimension d, float_type const & value) override;
+   bool end_frame() override;
+
+   uint64_t get_num_frames() const { return m_num_frames;}
+
+private:
+   FILE* m_file;
+   double m_frame_time;
+   uint64_t m_num_frames;
+   float_type m_aileron;
+   float_type m_elevator;
+   float_type m_rudder;
+   float_type m_throttle;
+};
+
+#endif // FG_EXT_TRACE_CONTROL_SINK_HPP_INCLUDED
@@ -0,0 +1,93 @@
+
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <linux/joystick.h>
+
+#include <joystick_reader.hpp>
+#include <latency_histogram.hpp>
+
+namespace {
+
+   /// @brief how often the read thread checks if it should stop, in ms
+   constexpr int stop_check_period_ms = 100;
+
+   /// @brief most events applied per publish
+   constexpr uint32_t max_events_per_read = 64;
+}
+
+joystick_reader::joystick_reader(const char* path)
+: m_fd{::open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC)},
+  m_state{},
+  m_connected{true},
+  m_running{false}
+{
+   if ( m_fd < 0){
+      throw("joystick_reader/open");
+   }
+}
+
+joystick_reader::~joystick_reader()
+{
+   stop();
+   ::close(m_fd);
+}
+
+void joystick_reader::start()
+{
+   if ( !m_running.exchange(true)){
+      m_thread = std::thread{[this]{ run();}};
+   }
+}
+
+void joystick_reader::stop()
+{
+   m_running = false;
+   if ( m_thread.joinable()){
+      m_thread.join();
+   }
+}
+
+void joystick_reader::run()
+{
+   joystick_state state{};
+   js_event events[max_events_per_read];
+   pollfd pfd{m_fd, POLLIN, 0};
+   while ( m_running.load(std::memory_order_relaxed)){
+      int const n = ::poll(&pfd, 1, stop_check_period_ms);
+      if ( n <= 0){
+         if ( (n < 0) && (errno != EINTR)){
+            break;
+         }
+         continue;
+      }
+      ssize_t const bytes = ::read(m_fd, events, sizeof(events));
+      if ( bytes < 0){
+         if ( (errno == EAGAIN) || (errno == EINTR)){
+            continue;
+         }
+         break;
+      }
+      if ( bytes == 0){
+         break;
+      }
+      int64_t const now = get_time_ns(CLOCK_MONOTONIC);
+      bool changed = false;
+      for ( uint32_t i = 0; i < bytes / sizeof(js_event); ++i){
+         js_event const & e = events[i];
+         // JS_EVENT_INIT events give the initial axis positions
+         if ( ((e.type & ~JS_EVENT_INIT) == JS_EVENT_AXIS) && (e.number < joystick_state::max_axes) ){
+            state.axes[e.number] = e.value;
+            state.event_time_ms = e.time;
+            ++state.num_events;
+            changed = true;
+         }
+      }
+      if ( changed){
+         state.time_ns = now;
+         m_state.store(state);
+      }
+   }
+   m_connected = false;
+}
@@ -0,0 +1,145 @@
+
+#include <csignal>
+#include <cstring>
+#include <latency_histogram.hpp>
+
+latency_histogram::latency_histogram(const char* name)
+: m_name{name}
+{
+   reset();
+}
+
+void latency_histogram::reset()
+{
+   m_count = 0;
+   m_sum = 0;
+   m_min = max_value;
+   m_max = 0;
+   ::memset(m_counts,0,sizeof(m_counts));
+}
+
+uint64_t latency_histogram::bucket_lowest_value(uint32_t idx)
+{
+   if ( idx < sub_bucket_count){
+      return idx;
+   }
+   uint32_t const shift = idx / sub_bucket_count - 1;
+   return static_cast<uint64_t>(idx % sub_bucket_count + sub_bucket_count) << shift;
+}
+
+uint64_t latency_histogram::bucket_width(uint32_t idx)
+{
+   if ( idx < sub_bucket_count){
+      return 1;
+   }
+   return 1ULL << (idx / sub_bucket_count - 1);
+}
+
+uint64_t latency_histogram::get_percentile(double p) const
+{
+   if ( m_count == 0){
+      return 0;
+   }
+   uint64_t const target = static_cast<uint64_t>((p / 100.0) * m_count + 0.5);
+   uint64_t sum = 0;
+   for ( uint32_t i = 0; i < num_buckets; ++i){
+      sum += m_counts[i];
+      if ( (sum >= target) && (sum > 0) ){
+         uint64_t const v = bucket_lowest_value(i) + bucket_width(i) / 2;
+         return (v > m_max) ? m_max : v;
+      }
+   }
+   return m_max;
+}
+
+void latency_histogram::dump(FILE* f) const
+{
+   ::fprintf(f,"%s : count = %llu, min = %llu ns, mean = %llu ns, max = %llu ns\n",
+      m_name,
+      static_cast<unsigned long long>(m_count),
+      static_cast<unsigned long long>(get_min()),
+      static_cast<unsigned long long>(get_mean()),
+      static_cast<unsigned long long>(m_max)
+   );
+   if ( m_count == 0){
+      return;
+   }
+   ::fprintf(f,"   p50 = %llu ns, p90 = %llu ns, p99 = %llu ns, p99.9 = %llu ns\n",
+      static_cast<unsigned long long>(get_percentile(50.0)),
+      static_cast<unsigned long long>(get_percentile(90.0)),
+      static_cast<unsigned long long>(get_percentile(99.0)),
+      static_cast<unsigned long long>(get_percentile(99.9))
+   );
+   for ( uint32_t i = 0; i < num_buckets; ++i){
+      if ( m_counts[i] > 0){
+         ::fprintf(f,"   [%12llu, %12llu) ns : %llu\n",
+            static_cast<unsigned long long>(bucket_lowest_value(i)),
+            static_cast<unsigned long long>(bucket_lowest_value(i) + bucket_width(i)),
+            static_cast<unsigned long long>(m_counts[i])
+         );
+      }
+   }
+}
+
+namespace {
+
+   latency_histogram stage_histograms[] = {
+      latency_histogram{"arrival"},
+      latency_histogram{"decode"},
+      latency_histogram{"pre_update"},
+      latency_histogram{"set_control"},
+      latency_histogram{"end_to_end"},
+      latency_histogram{"joystick_input"}
+   };
+
+   static_assert( (sizeof(stage_histograms) / sizeof(stage_histograms[0]) )
+      == static_cast<uint32_t>(latency_stage::NumStages),"");
+
+   volatile sig_atomic_t dump_requested = 0;
+
+   void on_dump_signal(int)
+   {
+      dump_requested = 1;
+   }
+}
+
+latency_histogram & get_latency_histogram(latency_stage stage)
+{
+   return stage_histograms[static_cast<uint32_t>(stage)];
+}
+
+void dump_latency_histograms(FILE* f)
+{
+   for ( auto const & h : stage_histograms){
+      h.dump(f);
+   }
+   ::fflush(f);
+}
+
+void dump_latency_histograms_on_signal(int sig)
+{
+   struct sigaction sa;
+   ::memset(&sa,0,sizeof(sa));
+   sa.sa_handler = on_dump_signal;
+   sa.sa_flags = SA_RESTART;
+   ::sigemptyset(&sa.sa_mask);
+   if ( ::sigaction(sig,&sa,nullptr) < 0){
+      throw("dump_latency_histograms_on_signal/sigaction");
+   }
+}
+
+bool take_latency_dump_request()
+{
+   if ( dump_requested){
+      dump_requested = 0;
+      return true;
+   }
+   return false;
+}
+
+void service_latency_dump_request(FILE* f)
+{
+   if ( take_latency_dump_request()){
+      dump_latency_histograms(f);
+   }
+}
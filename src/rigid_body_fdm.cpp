@@ -0,0 +1,279 @@
+
+#include <cmath>
+#include <cstring>
+#include <arpa/inet.h>
+#include <quan/constrain.hpp>
+#include <rigid_body_fdm.hpp>
+
+namespace {
+
+   using fdm_t = autoconv_FGNetFDM;
+
+   static_assert(sizeof(autoconv_FGNetFDM) == sizeof(FGNetFDM),"");
+
+   constexpr double gravity = 9.80665;
+   constexpr double earth_radius = 6371000.0;
+   constexpr double sea_level_density = 1.225;
+   constexpr double ft_per_m = 1.0 / 0.3048;
+   constexpr double knots_per_m_per_s = 3600.0 / 1852.0;
+   constexpr double pi = 3.14159265358979;
+
+   /**
+    * @brief body to north east down rotation matrix from unit quaternion q
+    **/
+   void get_rotation(double const (&q)[4], double (&r)[3][3])
+   {
+      double const w = q[0], x = q[1], y = q[2], z = q[3];
+      r[0][0] = 1 - 2 * (y * y + z * z);
+      r[0][1] = 2 * (x * y - w * z);
+      r[0][2] = 2 * (x * z + w * y);
+      r[1][0] = 2 * (x * y + w * z);
+      r[1][1] = 1 - 2 * (x * x + z * z);
+      r[1][2] = 2 * (y * z - w * x);
+      r[2][0] = 2 * (x * z - w * y);
+      r[2][1] = 2 * (y * z + w * x);
+      r[2][2] = 1 - 2 * (x * x + y * y);
+   }
+
+   /**
+    * @brief angle of attack for lift equal to weight in level flight at the start airspeed
+    **/
+   double get_level_flight_alpha(rigid_body_fdm_params const & p)
+   {
+      double const qbar_s = 0.5 * p.air_density * p.airspeed * p.airspeed * p.wing_area;
+      return (p.mass * gravity / qbar_s - p.CL0) / p.CL_alpha;
+   }
+
+   void get_euler(double const (&r)[3][3], double (&euler)[3])
+   {
+      euler[0] = std::atan2(r[2][1],r[2][2]);
+      euler[1] = std::asin(quan::constrain(-r[2][0],-1.0,1.0));
+      double const psi = std::atan2(r[1][0],r[0][0]);
+      euler[2] = (psi < 0.0) ? (psi + 2 * pi) : psi;
+   }
+}
+
+rigid_body_fdm::rigid_body_fdm(rigid_body_fdm_params const & params)
+: m_params{params},
+  m_trim_alpha{get_level_flight_alpha(params)},
+  m_aileron{0},
+  m_elevator{0},
+  m_rudder{0},
+  m_throttle{0},
+  m_fdm{}
+{
+   reset();
+}
+
+void rigid_body_fdm::reset()
+{
+   // version set and padding and the values not modelled 0, as FlightGear sends them.
+   // autoconv_FGNetFDM only sets the version itself, so start from a zeroed FGNetFDM
+   FGNetFDM raw{};
+   raw.version = htonl(FG_NET_FDM_VERSION);
+   raw.padding = 0;
+   ::memcpy(&m_fdm,&raw,sizeof(m_fdm));
+
+   // level and trimmed, with the angle of attack to give lift equal to weight at the start airspeed
+   double const pitch = m_trim_alpha;
+
+   double const cp = std::cos(pitch * 0.5), sp = std::sin(pitch * 0.5);
+   double const ch = std::cos(m_params.heading * 0.5), sh = std::sin(m_params.heading * 0.5);
+   m_attitude[0] = cp * ch;
+   m_attitude[1] = -sp * sh;
+   m_attitude[2] = sp * ch;
+   m_attitude[3] = cp * sh;
+
+   for ( auto & v : m_rates){ v = 0.0;}
+   m_velocity[0] = m_params.airspeed * std::cos(m_params.heading);
+   m_velocity[1] = m_params.airspeed * std::sin(m_params.heading);
+   m_velocity[2] = 0.0;
+   m_specific_force[0] = 0.0;
+   m_specific_force[1] = 0.0;
+   m_specific_force[2] = -gravity;
+   m_alpha = pitch;
+   m_beta = 0.0;
+   m_latitude = m_params.latitude;
+   m_longitude = m_params.longitude;
+   m_altitude = m_params.altitude;
+   m_time = 0.0;
+   m_on_ground = false;
+   update_fdm();
+}
+
+bool rigid_body_fdm::set_control(FlightDimension d, float_type const & value)
+{
+   switch(d){
+      case FlightDimension::Roll:
+         m_aileron = quan::constrain(value,float_type(-1),float_type(1));
+         break;
+      case FlightDimension::Pitch:
+         m_elevator = quan::constrain(value,float_type(-1),float_type(1));
+         break;
+      case FlightDimension::Yaw:
+         m_rudder = quan::constrain(value,float_type(-1),float_type(1));
+         break;
+      case FlightDimension::Throttle:
+         m_throttle = quan::constrain(value,float_type(0),float_type(1));
+         break;
+      default:
+         break;
+   }
+   return true;
+}
+
+void rigid_body_fdm::update(quan::time::ms const & time_step)
+{
+   double const dt = time_step.numeric_value() / 1000.0;
+   if ( dt <= 0.0){
+      return;
+   }
+   if ( m_on_ground){
+      m_time += dt;
+   }else{
+      int const num_steps = static_cast<int>(std::ceil(dt / m_params.max_step));
+      double const h = dt / num_steps;
+      for ( int i = 0; (i < num_steps) && !m_on_ground; ++i){
+         step(h);
+      }
+   }
+   update_fdm();
+}
+
+void rigid_body_fdm::step(double dt)
+{
+   rigid_body_fdm_params const & p = m_params;
+   double r[3][3];
+   get_rotation(m_attitude,r);
+
+   // no wind, so the airflow is the velocity in body frame
+   double const u = r[0][0] * m_velocity[0] + r[1][0] * m_velocity[1] + r[2][0] * m_velocity[2];
+   double const v = r[0][1] * m_velocity[0] + r[1][1] * m_velocity[1] + r[2][1] * m_velocity[2];
+   double const w = r[0][2] * m_velocity[0] + r[1][2] * m_velocity[1] + r[2][2] * m_velocity[2];
+   double const airspeed = std::fmax(std::sqrt(u * u + v * v + w * w),0.1);
+   m_alpha = std::atan2(w,u);
+   m_beta = std::asin(quan::constrain(v / airspeed,-1.0,1.0));
+
+   // forces in body frame
+   double const qbar_s = 0.5 * p.air_density * airspeed * airspeed * p.wing_area;
+   double const CL = quan::constrain(p.CL0 + p.CL_alpha * m_alpha,-p.CL_max,p.CL_max);
+   double const lift = qbar_s * CL;
+   double const drag = qbar_s * (p.CD0 + p.induced_drag_k * CL * CL);
+   double const side_force = qbar_s * p.CY_beta * m_beta;
+   double const thrust = p.max_thrust * m_throttle;
+   double const cos_alpha = std::cos(m_alpha), sin_alpha = std::sin(m_alpha);
+   m_specific_force[0] = (lift * sin_alpha - drag * u / airspeed + thrust) / p.mass;
+   m_specific_force[1] = (side_force - drag * v / airspeed) / p.mass;
+   m_specific_force[2] = (-lift * cos_alpha - drag * w / airspeed) / p.mass;
+
+   // moments in body frame, controls plus stability and damping
+   double const (&I)[3] = p.inertia;
+   double const pr = m_rates[0], qr = m_rates[1], rr = m_rates[2];
+   double const L = m_aileron * p.max_control_torque[0]
+      - I[0] * (pr / p.roll_time_constant + p.dihedral_effect * m_beta);
+   double const M = -m_elevator * p.max_control_torque[1]
+      - I[1] * (p.pitch_frequency * p.pitch_frequency * (m_alpha - m_trim_alpha)
+         + 2 * p.pitch_damping_ratio * p.pitch_frequency * qr);
+   double const N = m_rudder * p.max_control_torque[2]
+      + I[2] * (p.yaw_frequency * p.yaw_frequency * m_beta
+         - 2 * p.yaw_damping_ratio * p.yaw_frequency * rr);
+
+   // Euler's equations for the principal axes
+   m_rates[0] += (L - (I[2] - I[1]) * qr * rr) / I[0] * dt;
+   m_rates[1] += (M - (I[0] - I[2]) * rr * pr) / I[1] * dt;
+   m_rates[2] += (N - (I[1] - I[0]) * pr * qr) / I[2] * dt;
+
+   // semi implicit Euler, integrate the position with the new velocity
+   for ( int i = 0; i < 3; ++i){
+      m_velocity[i] += (r[i][0] * m_specific_force[0] + r[i][1] * m_specific_force[1]
+         + r[i][2] * m_specific_force[2]) * dt;
+   }
+   m_velocity[2] += gravity * dt;
+   m_latitude += m_velocity[0] * dt / earth_radius;
+   m_longitude += m_velocity[1] * dt / (earth_radius * std::cos(m_latitude));
+   m_altitude -= m_velocity[2] * dt;
+
+   double (&q)[4] = m_attitude;
+   double const h = 0.5 * dt;
+   double const qw = q[0] + (-q[1] * m_rates[0] - q[2] * m_rates[1] - q[3] * m_rates[2]) * h;
+   double const qx = q[1] + (q[0] * m_rates[0] + q[2] * m_rates[2] - q[3] * m_rates[1]) * h;
+   double const qy = q[2] + (q[0] * m_rates[1] - q[1] * m_rates[2] + q[3] * m_rates[0]) * h;
+   double const qz = q[3] + (q[0] * m_rates[2] + q[1] * m_rates[1] - q[2] * m_rates[0]) * h;
+   double const inv_n = 1.0 / std::sqrt(qw * qw + qx * qx + qy * qy + qz * qz);
+   q[0] = qw * inv_n;
+   q[1] = qx * inv_n;
+   q[2] = qy * inv_n;
+   q[3] = qz * inv_n;
+
+   m_time += dt;
+
+   if ( m_altitude <= p.ground_elevation){
+      m_altitude = p.ground_elevation;
+      for ( auto & vel : m_velocity){ vel = 0.0;}
+      for ( auto & rate : m_rates){ rate = 0.0;}
+      m_on_ground = true;
+   }
+}
+
+void rigid_body_fdm::get_euler_angles(double (&euler)[3]) const
+{
+   double r[3][3];
+   get_rotation(m_attitude,r);
+   get_euler(r,euler);
+}
+
+double rigid_body_fdm::get_airspeed() const
+{
+   return std::sqrt(m_velocity[0] * m_velocity[0] + m_velocity[1] * m_velocity[1] + m_velocity[2] * m_velocity[2]);
+}
+
+void rigid_body_fdm::update_fdm()
+{
+   double r[3][3];
+   get_rotation(m_attitude,r);
+   double euler[3];
+   get_euler(r,euler);
+
+   // body rates to euler rates
+   double const sin_phi = std::sin(euler[0]), cos_phi = std::cos(euler[0]);
+   double const cos_theta = std::fmax(std::cos(euler[1]),1e-6);
+   double const qr_sin_rr_cos = m_rates[1] * sin_phi + m_rates[2] * cos_phi;
+   double const phidot = m_rates[0] + qr_sin_rr_cos * std::tan(euler[1]);
+   double const thetadot = m_rates[1] * cos_phi - m_rates[2] * sin_phi;
+   double const psidot = qr_sin_rr_cos / cos_theta;
+
+   double const (&vel)[3] = m_velocity;
+   double const u = r[0][0] * vel[0] + r[1][0] * vel[1] + r[2][0] * vel[2];
+   double const v = r[0][1] * vel[0] + r[1][1] * vel[1] + r[2][1] * vel[2];
+   double const w = r[0][2] * vel[0] + r[1][2] * vel[1] + r[2][2] * vel[2];
+   double const cas = get_airspeed() * std::sqrt(m_params.air_density / sea_level_density);
+
+   m_fdm.longitude = fdm_t::rad<double>{m_longitude};
+   m_fdm.latitude = fdm_t::rad<double>{m_latitude};
+   m_fdm.altitude = fdm_t::meters<double>{m_altitude};
+   m_fdm.agl = fdm_t::meters<>{static_cast<float>(m_altitude - m_params.ground_elevation)};
+   m_fdm.phi = fdm_t::rad<>{static_cast<float>(euler[0])};
+   m_fdm.theta = fdm_t::rad<>{static_cast<float>(euler[1])};
+   m_fdm.psi = fdm_t::rad<>{static_cast<float>(euler[2])};
+   m_fdm.alpha = fdm_t::rad<>{static_cast<float>(m_alpha)};
+   m_fdm.beta = fdm_t::rad<>{static_cast<float>(m_beta)};
+   m_fdm.phidot = fdm_t::rad_per_s<>{fdm_t::rad<>{static_cast<float>(phidot)}};
+   m_fdm.thetadot = fdm_t::rad_per_s<>{fdm_t::rad<>{static_cast<float>(thetadot)}};
+   m_fdm.psidot = fdm_t::rad_per_s<>{fdm_t::rad<>{static_cast<float>(psidot)}};
+   m_fdm.vcas = fdm_t::knots<>{static_cast<float>(cas * knots_per_m_per_s)};
+   m_fdm.climb_rate = fdm_t::ft_per_s<>{static_cast<float>(-vel[2] * ft_per_m)};
+   m_fdm.v_north = fdm_t::ft_per_s<>{static_cast<float>(vel[0] * ft_per_m)};
+   m_fdm.v_east = fdm_t::ft_per_s<>{static_cast<float>(vel[1] * ft_per_m)};
+   m_fdm.v_down = fdm_t::ft_per_s<>{static_cast<float>(vel[2] * ft_per_m)};
+   m_fdm.v_body_u = fdm_t::ft_per_s<>{static_cast<float>(u * ft_per_m)};
+   m_fdm.v_body_v = fdm_t::ft_per_s<>{static_cast<float>(v * ft_per_m)};
+   m_fdm.v_body_w = fdm_t::ft_per_s<>{static_cast<float>(w * ft_per_m)};
+   m_fdm.A_X_pilot = fdm_t::ft_per_s2<>{static_cast<float>(m_specific_force[0] * ft_per_m)};
+   m_fdm.A_Y_pilot = fdm_t::ft_per_s2<>{static_cast<float>(m_specific_force[1] * ft_per_m)};
+   m_fdm.A_Z_pilot = fdm_t::ft_per_s2<>{static_cast<float>(m_specific_force[2] * ft_per_m)};
+   m_fdm.cur_time = m_params.start_time + static_cast<uint32_t>(m_time);
+   m_fdm.elevator = static_cast<float>(m_elevator);
+   m_fdm.left_aileron = static_cast<float>(m_aileron);
+   m_fdm.right_aileron = static_cast<float>(-m_aileron);
+   m_fdm.rudder = static_cast<float>(m_rudder);
+}
@@ -19,7 +19,7 @@ namespace {
 quan::frequency::Hz get_frame_rate(fgfs_telnet & t)
 {
    int32_t frame_rate;
-   if ( t.get("/sim[0]/frame-rate",frame_rate)){
+   if ( t.get(fgfs_prop::FrameRate,frame_rate)){
       m_frame_rate = quan::frequency::Hz{frame_rate};
       return  m_frame_rate;
    }else{
@@ -0,0 +1,62 @@
+
+#include <cstring>
+#include <format_fixed.hpp>
+#include <fgfs_property.hpp>
+#include <telnet_control_sink.hpp>
+
+namespace {
+
+   char* append(char* first, char* last, const char* str, size_t len)
+   {
+      if ( static_cast<size_t>(last - first) < len){
+         return nullptr;
+      }
+      ::memcpy(first, str, len);
+      return first + len;
+   }
+}
+
+bool telnet_control_sink::begin_frame()
+{
+   m_frame_len = 0;
+   return true;
+}
+
+bool telnet_control_sink::set_control(FlightDimension d, float_type const & value)
+{
+   fgfs_prop const prop = get_control_property(d);
+   if ( prop == fgfs_prop::NumProps){
+      return false;
+   }
+   // "set <path> " is prerendered, so only the value needs formatting
+   for (int attempt = 0; attempt < 2; ++attempt){
+      char* const last = m_frame_buffer + max_frame_size;
+      char* p = append(m_frame_buffer + m_frame_len, last, get_set_prefix(prop), get_set_prefix_len(prop));
+      p = p ? format_fixed(p, last, static_cast<double>(value)) : nullptr;
+      p = p ? append(p, last, "\015\012", 2) : nullptr;
+      if ( p != nullptr){
+         m_frame_len = p - m_frame_buffer;
+         return true;
+      }
+      // buffer full so send what we have and try again
+      if ( (m_frame_len == 0) || !flush()){
+         return false;
+      }
+   }
+   return false;
+}
+
+bool telnet_control_sink::end_frame()
+{
+   return flush();
+}
+
+bool telnet_control_sink::flush()
+{
+   if ( m_frame_len == 0){
+      return true;
+   }
+   size_t const len = m_frame_len;
+   m_frame_len = 0;
+   return m_telnet.write_all(m_frame_buffer, len);
+}
@@ -0,0 +1,51 @@
+
+#include <trace_control_sink.hpp>
+
+trace_control_sink::trace_control_sink(FILE* f)
+: m_file{f},
+  m_frame_time{0.0},
+  m_num_frames{0},
+  m_aileron{0},
+  m_elevator{0},
+  m_rudder{0},
+  m_throttle{0}
+{
+   if ( m_file != nullptr){
+      ::fprintf(m_file,"time_s,aileron,elevator,rudder,throttle\n");
+   }
+}
+
+bool trace_control_sink::set_control(FlightDimension d, float_type const & value)
+{
+   switch(d){
+      case FlightDimension::Roll:
+         m_aileron = value;
+         return true;
+      case FlightDimension::Pitch:
+         m_elevator = value;
+         return true;
+      case FlightDimension::Yaw:
+         m_rudder = value;
+         return true;
+      case FlightDimension::Throttle:
+         m_throttle = value;
+         return true;
+      default:
+         return true;
+   }
+}
+
+bool trace_control_sink::end_frame()
+{
+   ++m_num_frames;
+   if ( m_file == nullptr){
+      return true;
+   }
+   return ::fprintf(m_file,"%.6f,%.6f,%.6f,%.6f,%.6f\n",
+      m_frame_time,
+      static_cast<double>(m_aileron),
+      static_cast<double>(m_elevator),
+      static_cast<double>(m_rudder),
+      static_cast<double>(m_throttle)
+   ) > 0;
+}